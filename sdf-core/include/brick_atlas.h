@@ -0,0 +1,131 @@
+#pragma once
+
+#include "local_sdf.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+
+struct BrickAtlasSettings {
+    std::size_t memory_budget = std::size_t(64) << 20; // bytes of brick data for all assets together
+    glm::uint32 num_io_threads = 2;
+    DistanceField::Encoding encoding = DistanceField::Encoding::uniform_8bit;      // of every asset, slots keep bricks as baked
+    DistanceField::BrickConfig brick_config = DistanceField::DEFAULT_BRICK_CONFIG; // of every asset, sets the slot size
+};
+
+/// fixed-size pool of brick slots shared by many distance field assets.
+/// The always loaded mip of an asset stays resident from registration on, streamed mips are read from the baked file on
+/// I/O threads when requested and evicted least recently requested first once the pool is full.
+/// NOTE: not thread-safe, call it from one thread, only file reads happen elsewhere
+class BrickAtlas {
+public:
+    using AssetId = glm::uint32;
+
+    /// slots per row and column of a pool layer, the pool is a stack of such layers
+    static constexpr glm::uint32 POOL_WIDTH_IN_BRICKS = 32;
+
+    explicit BrickAtlas(BrickAtlasSettings const &settings);
+    ~BrickAtlas();
+
+    BrickAtlas(const BrickAtlas &) = delete;
+    BrickAtlas &operator=(const BrickAtlas &) = delete;
+
+    /// reads the header and always loaded mip of a file written by `DistanceFieldVolumeData::serialize`, nullopt if the file is
+    /// unreadable or of another version, baked with another encoding or brick config than the pool or its always loaded mip does not fit
+    std::optional<AssetId> registerAsset(const char *file_path);
+
+    /// wants mips from `mip_index` to the coarsest until the next `update`, coarser ones are kept as fallback
+    void requestMip(AssetId asset_id, glm::uint32 mip_index);
+
+    /// moves finished loads into the pool, evicting mips not requested since the last update, then queues loads for new requests
+    void update();
+
+    /// finest mip of the asset in the pool, the always loaded one at worst
+    [[nodiscard]] glm::uint32 getFinestResidentMip(AssetId asset_id) const;
+
+    /// true once a loaded mip found no slots it could take, it is not read again until an eviction frees some
+    [[nodiscard]] bool isMipOutOfSlots(AssetId asset_id, glm::uint32 mip_index) const;
+
+    /// indirection table of a resident mip remapped to pool slots, INVALID_BRICK_INDEX where there is no brick,
+    /// child blocks of split bricks keep their layout (see DistanceField::REFINED_BRICK_FLAG). Empty if the mip is not resident
+    [[nodiscard]] std::span<const glm::uint32> getIndirectionTable(AssetId asset_id, glm::uint32 mip_index) const;
+
+    /// dimensions and distance encoding of a mip, resident or not
+    [[nodiscard]] SparseDistanceFieldMip const &getMipInfo(AssetId asset_id, glm::uint32 mip_index) const;
+
+    [[nodiscard]] const glm::uint8 *getSlotData(glm::uint32 slot) const { return pool_.data() + std::size_t(slot) * brick_size_bytes_; }
+    /// decodes the voxels of a slot with `DistanceField::decode_voxel`, (1, 0) for encodings without a per-brick one
+    [[nodiscard]] glm::vec2 getSlotScaleBias(glm::uint32 slot) const { return slot_scale_bias_[slot]; }
+    [[nodiscard]] glm::uvec3 getSlotCoordinate(glm::uint32 slot) const;
+
+    [[nodiscard]] glm::uint32 getNumSlots() const { return num_slots_; }
+    [[nodiscard]] glm::uint32 getNumFreeSlots() const { return (glm::uint32) free_slots_.size(); }
+    [[nodiscard]] std::size_t getNumPendingLoads() const { return num_pending_loads_; }
+
+private:
+    struct ResidentMip {
+        std::vector<glm::uint32> indirection_table; // empty while not resident
+        std::vector<glm::uint32> slots;
+        std::uint64_t last_requested_update = 0;
+        std::optional<std::uint64_t> out_of_slots_evictions; // evictions so far when it last found no slots
+        bool b_loading = false;
+        bool b_pinned = false; // always loaded mip
+    };
+
+    struct Asset {
+        std::string file_path;
+        DistanceFieldVolumeData header; // without brick data
+        std::uint64_t streamable_mips_offset;
+        std::array<ResidentMip, DistanceField::NUM_MIPS> mips;
+        glm::uint32 requested_mip = DistanceField::NUM_MIPS - 1;
+    };
+
+    // copied, I/O threads never touch assets
+    struct LoadRequest {
+        AssetId asset_id;
+        glm::uint32 mip_index;
+        std::string file_path;
+        std::uint64_t file_offset;
+        std::size_t size;
+    };
+
+    struct LoadResult {
+        AssetId asset_id;
+        glm::uint32 mip_index;
+        std::vector<glm::uint8> mip_data;
+        bool b_success;
+    };
+
+    void ioThreadMain();
+
+    /// copies the bricks of a mip blob into free slots, evicting other mips if needed
+    bool makeResident(AssetId asset_id, glm::uint32 mip_index, std::span<const glm::uint8> mip_data);
+    void evict(ResidentMip &mip);
+
+    /// evicts least recently requested mips until `num_slots` are free, false if not possible
+    bool reserveSlots(std::size_t num_slots);
+
+    DistanceField::Encoding encoding_;
+    DistanceField::BrickConfig brick_config_;
+    glm::uint32 brick_size_bytes_;
+    glm::uint32 num_slots_;
+    std::vector<glm::uint8> pool_;
+    std::vector<glm::vec2> slot_scale_bias_;
+    std::vector<glm::uint32> free_slots_;
+    std::vector<std::unique_ptr<Asset>> assets_;
+    std::uint64_t update_index_ = 1;
+    std::uint64_t num_evictions_ = 0;
+    std::size_t num_pending_loads_ = 0;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_condition_;
+    std::deque<LoadRequest> load_queue_;
+    std::vector<LoadResult> finished_loads_;
+    bool b_stopping_ = false;
+    std::vector<std::thread> io_threads_;
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <embree4/rtcore.h>
+#include <embree4/rtcore_ray.h>
+#include <array>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x3.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+struct Mesh;
+struct MeshPseudoNormals;
+struct Box;
+
+namespace embree {
+
+/// one device for the whole process, created on first use, so bakes after the first skip its start-up cost
+RTCDevice get_shared_device();
+
+/// device with no build threads of its own, scenes commit on the calling thread alone and their BVH pages are first touched where
+/// it runs. The caller releases it
+RTCDevice new_calling_thread_device();
+
+struct Geometry {
+    std::span<const glm::uvec3> indices_buffer;
+    std::span<const glm::vec3> vertices_buffer;
+    RTCGeometry handle = nullptr;                        // transformed geometry handle
+    MeshPseudoNormals const *pseudo_normals = nullptr; // sign without rays, see Scene::isInsideAt
+};
+
+/// BVH of a mesh built once for all its instances
+struct Prototype {
+    Geometry geometry;
+    RTCScene scene = nullptr;
+};
+
+/// prototype placed in the scene, see Scene::addInstance
+struct Instance {
+    glm::uint32 prototype_index;
+    glm::mat4x3 local_to_world;
+    glm::mat4x3 world_to_local;
+    glm::mat3 normal_to_world; // inverse transpose of the linear part
+    bool b_mirrored;           // getTriangle swaps two corners so the winding still faces out
+    bool b_similarity;         // rotation, uniform scale and mirroring only, closest points map to closest points
+    RTCGeometry handle = nullptr;
+};
+
+struct MeshQuerySettings {
+    float max_distance = std::numeric_limits<float>::infinity(); // points further from the mesh get no result
+    bool b_signed = false;          // negative distance inside, from Scene::isInsideAt or else voted with sign rays as in the bake
+    glm::uint32 num_sign_rays = 64; // rounded up to a direction table, see fibonacci_sphere_directions
+    bool parallel = true;
+};
+
+/// exact answer of a batched query for one point, on the source triangles
+struct MeshQueryResult {
+    glm::vec3 closest_point;
+    glm::vec3 normal;                              // unit geometric normal of the closest triangle, as RayHit::getHitNormal
+    glm::vec2 barycentrics;                        // of closest_point, weights of the 2nd and 3rd vertex like embree's u, v
+    float distance;                                // max_distance without result, negative inside with b_signed
+    glm::uint32 geom_id = RTC_INVALID_GEOMETRY_ID; // meshes in Scene::addMesh order, then instances in Scene::addInstance order
+    glm::uint32 prim_id = RTC_INVALID_GEOMETRY_ID;
+
+    [[nodiscard]] bool isValid() const { return geom_id != RTC_INVALID_GEOMETRY_ID; }
+};
+
+class Scene {
+public:
+    explicit Scene(RTCDevice device = get_shared_device());
+    ~Scene();
+
+    Scene(const Scene &) = delete;
+    Scene operator=(const Scene &) = delete;
+
+    /// `mesh` and `pseudo_normals`, if any, must outlive the scene
+    void addMesh(Mesh const &mesh, MeshPseudoNormals const *pseudo_normals = nullptr);
+
+    /// builds the BVH of `mesh` right away, any number of instances then share it and the mesh buffers.
+    /// Like for addMesh, `mesh` and `pseudo_normals` must outlive the scene
+    /// \return index for addInstance
+    glm::uint32 addPrototype(Mesh const &mesh, MeshPseudoNormals const *pseudo_normals = nullptr);
+
+    /// places a prototype with an affine transform, cheaper than a transformed copy in both memory and build time
+    void addInstance(glm::uint32 prototype_index, glm::mat4x3 const &local_to_world);
+
+    void commit();
+
+    /// world-space corners of triangle `prim_id` of scene geometry `geom_id`, numbered as MeshQueryResult::geom_id
+    [[nodiscard]] std::array<glm::vec3, 3> getTriangle(glm::uint32 geom_id, glm::uint32 prim_id) const;
+
+    /// sign of `point` from the pseudo-normal of the feature of triangle `prim_id` closest to it, which must be the closest
+    /// triangle of the scene. nullopt when the geometry has no pseudo-normals, is instanced with a non-similarity transform,
+    /// or `point` lies on the surface
+    [[nodiscard]] std::optional<bool> isInsideAt(glm::vec3 point, glm::uint32 geom_id, glm::uint32 prim_id) const;
+
+    /// closest point queries for a batch of points, split in chunks over threads with one set of query contexts per chunk.
+    /// `out_results` has one entry per point
+    void queryClosest(std::span<const glm::vec3> points, MeshQuerySettings const &settings, std::span<MeshQueryResult> out_results) const;
+
+    RTCDevice device_;
+    RTCScene scene_;
+    std::vector<Geometry> geos_;
+    std::vector<Prototype> prototypes_;
+    std::vector<Instance> instances_; // attached after geos_, their geometry ids follow
+};
+
+class RayHit : public RTCRayHit {
+public:
+    RayHit(glm::vec3 const &origin, glm::vec3 const &direction, float far);
+
+    [[nodiscard]] glm::vec3 getHitNormal() const;
+    [[nodiscard]] bool isValidHit() const { return hit.geomID != RTC_INVALID_GEOMETRY_ID && hit.primID != RTC_INVALID_GEOMETRY_ID; }
+};
+
+class IntersectionContext : public RTCIntersectArguments {
+public:
+    IntersectionContext(Scene const &scene) : scene_{scene} { rtcInitIntersectArguments(this); }
+
+    /// hits on instances come back like any other: geomID names the instance and Ng is in world space
+    RayHit emitRay(glm::vec3 const &origin, glm::vec3 const &direction, float far);
+
+    void emitRay(RayHit *rayhit);
+
+    /// sign vote of the bake: inside when more than a quarter of the rays from `origin` hit a back face within `far`
+    bool isInside(glm::vec3 const &origin, std::span<const glm::vec3> directions, float far);
+
+private:
+    Scene const &scene_;
+};
+
+class ClosestQueryResult {
+public:
+    glm::vec3 closest_point;
+    glm::uint32 geom_id = RTC_INVALID_GEOMETRY_ID; // closest triangle, invalid if nothing is within the radius
+    glm::uint32 prim_id = RTC_INVALID_GEOMETRY_ID;
+
+    // not free lunch, will call `sqrt()`
+    [[nodiscard]] float getDistance() const;
+
+private:
+    friend class ClosestQueryContext;
+
+    glm::vec3 query_position; // world space, instanced triangles are compared there
+    float query_distance_sq;
+};
+
+class ClosestQueryContext : public RTCPointQueryContext {
+public:
+    ClosestQueryContext(Scene const &scene);
+
+    ClosestQueryResult query(glm::vec3 center, float radius);
+
+    float queryDistance(glm::vec3 center, float radius) { return query(center, radius).getDistance(); }
+
+private:
+    static bool closestQueryFunc(RTCPointQueryFunctionArguments *args);
+
+    Scene const &scene_;
+};
+
+/// gathers all triangles whose bounds overlap a box, with a single BVH traversal
+class OverlapQueryContext : public RTCPointQueryContext {
+public:
+    OverlapQueryContext(Scene const &scene);
+
+    /// appends 3 vertices per triangle, and their (geom_id, prim_id) to `out_triangle_ids` if given.
+    /// Gives up and returns false once more than `max_triangles` are found
+    bool query(Box const &bounds, std::size_t max_triangles, std::vector<glm::vec3> &out_triangle_vertices,
+               std::vector<glm::uvec2> *out_triangle_ids = nullptr);
+
+private:
+    static bool overlapQueryFunc(RTCPointQueryFunctionArguments *args);
+
+    Scene const &scene_;
+};
+
+} // namespace embree
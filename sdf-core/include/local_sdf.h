@@ -0,0 +1,309 @@
+#pragma once
+
+#include "mesh.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <vector>
+
+namespace DistanceField {
+
+/// voxel layout of the bricks of a volume. Bake, packing and dump loops are instantiated per config, see dispatch_brick_config
+struct BrickConfig {
+    glm::uint32 brick_size;          // voxels per side, neighbour bricks share their border layer
+    glm::uint32 band_size_in_voxels; // trace distance of a mip in its voxels, about the brick radius
+
+    [[nodiscard]] constexpr glm::uint32 getUniqueDataBrickSize() const { return brick_size - 1; }
+    [[nodiscard]] constexpr glm::uint32 getBrickVoxelCount() const { return brick_size * brick_size * brick_size; }
+
+    constexpr bool operator==(BrickConfig const &) const = default;
+};
+
+constexpr BrickConfig BRICK_CONFIG_4{4, 2};   // thin geometry, less padding around small features
+constexpr BrickConfig BRICK_CONFIG_8{8, 4};   // UE5 layout
+constexpr BrickConfig BRICK_CONFIG_16{16, 8}; // large smooth surfaces, fewer bricks and indirection entries
+
+constexpr BrickConfig DEFAULT_BRICK_CONFIG = BRICK_CONFIG_8;
+
+/// calls `function.template operator()<Config>()` with the instantiated config equal to `config`, false for other configs
+template <typename Function>
+bool dispatch_brick_config(BrickConfig config, Function &&function) {
+    if (config == BRICK_CONFIG_4) {
+        function.template operator()<BRICK_CONFIG_4>();
+    } else if (config == BRICK_CONFIG_8) {
+        function.template operator()<BRICK_CONFIG_8>();
+    } else if (config == BRICK_CONFIG_16) {
+        function.template operator()<BRICK_CONFIG_16>();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+constexpr glm::uint32 INVALID_BRICK_INDEX = 0xFFFFFFFF;
+
+/// set on indirection entries of refined bricks, the other bits give the table offset of their 2x2x2 child entries (x fastest)
+constexpr glm::uint32 REFINED_BRICK_FLAG = 0x80000000;
+
+/// times a brick may be split at most, each level halves the voxel size
+constexpr glm::uint32 MAX_REFINEMENT_LEVELS = 3;
+
+constexpr bool is_refined_entry(glm::uint32 indirection_entry) {
+    return indirection_entry != INVALID_BRICK_INDEX && (indirection_entry & REFINED_BRICK_FLAG) != 0;
+}
+
+constexpr glm::uint32 MAX_INDIRECTION_DIMENSION = 1024;
+
+constexpr glm::uint32 MESH_DISTANCE_FIELD_OBJECT_BORDER = 1;
+
+constexpr glm::uint32 NUM_MIPS = 3;
+
+/// two-sided meshes are expanded by a fraction of a voxel, so central differencing has room around surfaces on the bounds
+constexpr float CENTRAL_DIFFERENCING_EXPAND_IN_VOXELS = 0.25f;
+
+/// unsigned distance is biased by this, giving two-sided surfaces a thin negative shell to hit
+constexpr float TWO_SIDED_SURFACE_OFFSET_IN_VOXELS = 0.25f;
+
+/// how brick voxels store distances, normalized over [-trace distance, +trace distance] of their mip
+enum class Encoding : glm::uint32 {
+    uniform_8bit, // UE5 layout, 8 bits over the whole range of the mip
+    brick_4bit,   // over the [min, max] of each brick, a (scale, bias) per brick follows the brick data
+    brick_8bit,
+    brick_16bit,
+};
+
+constexpr glm::uint32 get_bits_per_voxel(Encoding encoding) {
+    switch (encoding) {
+    case Encoding::brick_4bit: return 4;
+    case Encoding::brick_16bit: return 16;
+    default: return 8;
+    }
+}
+
+constexpr glm::uint32 get_brick_size_bytes(Encoding encoding, BrickConfig config) {
+    return (config.getBrickVoxelCount() * get_bits_per_voxel(encoding) + 7) / 8;
+}
+
+constexpr bool has_brick_scale_bias(Encoding encoding) {
+    return encoding != Encoding::uniform_8bit;
+}
+
+/// normalized distance of one voxel of a brick, `brick_scale_bias` is (1, 0) without a per-brick one
+inline float decode_voxel(const glm::uint8 *brick, glm::uint32 voxel_index, Encoding encoding, glm::vec2 brick_scale_bias) {
+    float code;
+    switch (encoding) {
+    case Encoding::brick_4bit: code = float(brick[voxel_index / 2] >> (voxel_index % 2 * 4) & 0xF) / 15.0f; break;
+    case Encoding::brick_16bit: {
+        glm::uint16 code16;
+        std::memcpy(&code16, brick + voxel_index * sizeof(code16), sizeof(code16));
+        code = float(code16) / 65535.0f;
+        break;
+    }
+    default: code = float(brick[voxel_index]) / 255.0f; break;
+    }
+    return code * brick_scale_bias.x + brick_scale_bias.y;
+}
+
+} // namespace DistanceField
+
+/// how the bake tells inside from outside
+enum class SignMode : glm::uint32 {
+    ray_vote,      // sign rays from voxels within the trace distance vote, copes with holes and self-intersections
+    pseudo_normal, // angle-weighted pseudo-normal at the closest feature, exact for closed manifold meshes, which need no rays
+};
+
+/// options of one bake, the generator reads no global state so bakes with different settings may run concurrently
+struct BakeSettings {
+    float voxel_density = 0.2f;
+    bool parallel = true;
+    bool triangle_binning = true;        // brute-force distance for bricks with few nearby triangles
+    std::size_t max_chunk_triangles = 0; // chunked bake, triangles per BVH chunk, 0 for a single BVH
+    bool morton_brick_order = false;     // pack valid bricks along a Z-order curve instead of x-fastest
+
+    /// sign rays per voxel near the surface for each mip, rounded up to a precomputed direction table (16 to 96).
+    /// Coarse mips only answer far-field queries, so they get by with fewer
+    std::array<glm::uint32, DistanceField::NUM_MIPS> num_sign_rays = {64, 48, 32};
+
+    /// with pseudo_normal, meshes that are not closed and manifold, non-similarity instances and bake chunks still vote
+    SignMode sign_mode = SignMode::ray_vote;
+
+    DistanceField::BrickConfig brick_config = DistanceField::DEFAULT_BRICK_CONFIG; // one of the dispatched BRICK_CONFIG_*
+
+    DistanceField::Encoding encoding = DistanceField::Encoding::uniform_8bit;
+    bool encoding_report = false; // print size and error of every encoding for each mip, costs an extra pass over the bricks
+
+    /// adaptive mip 0: bricks whose trilinear reconstruction misses exact distances by more than `refinement_error` mip-0 voxels
+    /// (checked at cell centers near the surface) are split in 2x2x2 bricks of twice the resolution, up to `refinement_levels` times
+    glm::uint32 refinement_levels = 0;
+    float refinement_error = 0.1f;
+
+    /// coarse mips are baked against a quadric-simplified mesh whose vertices stay within this fraction of the mip's voxel diagonal,
+    /// 0 bakes every mip against the full mesh. Mip 0 always uses it
+    float coarse_mip_lod_error = 0.0f;
+
+    /// NUMA placement: the brick grid is split in z slabs, one per node, each baked by threads pinned to its node so the bricks
+    /// they fill are first touched there. Idle threads help other nodes rather than wait
+    bool numa_placement = false;
+    glm::uint32 numa_simulated_nodes = 0; // split the CPUs in this many nodes instead of detecting them, to try it on one socket
+    bool numa_replicate_scenes = false;   // a copy of the meshes and BVHs per node, built from a thread pinned to it
+
+    glm::uint32 shard_index = 0; // with num_shards > 1, only bake this slab of z brick layers of every mip
+    glm::uint32 num_shards = 1;  // see merge_distance_field_shards
+};
+
+// -------------------- Forward Declarations ---------------------
+
+namespace embree {
+class Scene;
+}
+
+template <DistanceField::BrickConfig Config>
+class DistanceFieldBrickTask {
+public:
+    static constexpr glm::uint32 BRICK_SIZE = Config.brick_size;
+    static constexpr glm::uint32 BRICK_VOXEL_COUNT = Config.getBrickVoxelCount();
+
+    DistanceFieldBrickTask(embree::Scene const &embree_scene, std::span<const glm::vec3> sample_direction, float local_space_trace_distance,
+                           Box volume_bounds, glm::uvec3 brick_coordinate, glm::vec3 indirection_voxel_size,
+                           bool b_generate_as_if_two_sided, bool b_triangle_binning, glm::uint32 refinement_levels = 0,
+                           float refinement_error = 0.0f, SignMode sign_mode = SignMode::ray_vote);
+
+    void doWork();
+
+    // input, read-only
+    embree::Scene const &embree_scene;
+    std::span<const glm::vec3> sample_direction;
+    float local_space_trace_distance;
+    Box volume_bounds;
+    const glm::uvec3 brick_coordinate;
+    const glm::vec3 indirection_voxel_size;
+    const bool b_generate_as_if_two_sided; // skip sign rays, store biased unsigned distance
+    const bool b_triangle_binning;
+    const glm::uint32 refinement_levels; // splits left below this brick
+    const float refinement_error;        // local space, reconstruction error above which the brick is split
+    const SignMode sign_mode;
+
+    // outputs, min/max at 8 bits decide validity whatever the encoding
+    glm::uint8 brick_max_distance;
+    glm::uint8 brick_min_distance;
+    std::vector<glm::uint16> distance_field_volume;     // normalized distance at 16 bits, requantized when packed, empty if not stored
+    float max_reconstruction_error = 0.0f;              // local space, only measured when the brick may be split
+    std::vector<DistanceFieldBrickTask> refined_bricks; // 2x2x2 children (x fastest) replacing this brick, if split
+};
+
+struct SparseDistanceFieldMip {
+    glm::uvec3 indirection_dimensions;
+    glm::uint32 num_distance_field_bricks;
+    glm::uint32 num_refined_bricks; // each appends a block of 8 child entries to the indirection table
+    glm::vec3 volume_to_virtual_uv_scale;
+    glm::vec3 volume_to_virtual_uv_add;
+    glm::vec2 distance_field_to_volume_scale_bias;
+
+    glm::uint32 bulk_offset;
+    glm::uint32 bulk_size;
+
+    /// entries of the indirection dimensions followed by the child blocks of refined bricks
+    [[nodiscard]] std::size_t getIndirectionTableSize() const {
+        return std::size_t(indirection_dimensions.x) * indirection_dimensions.y * indirection_dimensions.z +
+               std::size_t(num_refined_bricks) * 8;
+    }
+};
+
+/// defered clean-up resource
+class DistanceFieldVolumeData {
+public:
+    Box local_space_mesh_bounds;
+
+    bool b_mostly_two_sided;
+
+    DistanceField::Encoding encoding = DistanceField::Encoding::uniform_8bit;
+
+    DistanceField::BrickConfig brick_config = DistanceField::DEFAULT_BRICK_CONFIG;
+
+    std::array<SparseDistanceFieldMip, DistanceField::NUM_MIPS> mips;
+
+    std::vector<glm::uint8> always_loaded_mip;
+
+    // bulk data, a BrickAtlas streams mips of it from the serialized file on demand
+    std::vector<glm::uint8> streamable_mips;
+
+    /// serialized volumes start with these, bump the version whenever the fields below change
+    static constexpr glm::uint32 SERIALIZED_MAGIC = 0x56464453; // "SDFV"
+    static constexpr glm::uint32 SERIALIZED_VERSION = 1;
+
+    static void serialize(std::ostream &os, DistanceFieldVolumeData const &data);
+    /// false if `is` does not hold a volume of the current version or is truncated
+    static bool deserialize(std::istream &is, DistanceFieldVolumeData &data);
+
+    /// everything before the streamable mips, `is` is left on their serialized size followed by their bytes
+    static bool deserializeHeader(std::istream &is, DistanceFieldVolumeData &data);
+};
+
+/// cancellation, wall-clock budget and progress of a running bake, shared with the baking thread
+struct DistanceFieldBakeControl {
+    std::atomic<bool> b_cancelled = false;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    std::atomic<std::size_t> num_baked_bricks = 0;
+    std::atomic<std::size_t> num_total_bricks = 0;
+
+    /// finest mip baked so far, NUM_MIPS while none is complete
+    std::atomic<glm::uint32> finest_complete_mip = DistanceField::NUM_MIPS;
+
+    /// called from the baking thread each time a finer mip completes, with all mips baked so far
+    std::function<void(DistanceFieldVolumeData const &data, glm::uint32 finest_complete_mip)> on_mip_complete;
+
+    [[nodiscard]] bool isStopped() const { return b_cancelled || std::chrono::steady_clock::now() >= deadline; }
+};
+
+/// NOTE: part of FMeshUtilities in ue5
+/// with a `control`, mips are baked one by one from the coarsest, and `out_data` only holds the complete ones
+/// thread-safe, any number of bakes may run at once
+void generate_distance_field_volume_data(Mesh const &mesh, Box bounds, float distance_field_resolution_scale,
+                                         bool b_generate_as_if_two_sided, BakeSettings const &settings, DistanceFieldVolumeData &out_data,
+                                         DistanceFieldBakeControl *control = nullptr);
+
+/// one volume for several meshes, each instance placing a mesh with an affine transform. Instances of the same mesh share its
+/// buffers and a single BVH, `bounds` should hold all of them (see MeshInstance::getAABB)
+void generate_distance_field_volume_data(std::span<const MeshInstance> instances, Box bounds, float distance_field_resolution_scale,
+                                         bool b_generate_as_if_two_sided, BakeSettings const &settings, DistanceFieldVolumeData &out_data,
+                                         DistanceFieldBakeControl *control = nullptr);
+
+/// combines the bakes of every shard (`BakeSettings::shard_index` from 0 to num_shards - 1) of one mesh into the full volume,
+/// packed as if baked in one go. false if the shards do not come from the same bake
+bool merge_distance_field_shards(std::span<const DistanceFieldVolumeData> shards, BakeSettings const &settings,
+                                 DistanceFieldVolumeData &out_data);
+
+/// boolean of two baked volumes, see combine_distance_fields
+enum class CsgOperation : glm::uint32 {
+    unite,
+    intersect,
+    subtract,     // a minus b
+    smooth_unite, // polynomial smooth minimum, blending the surfaces where their distances are within `smooth_radius`
+};
+
+struct CsgSettings {
+    CsgOperation operation = CsgOperation::unite;
+    glm::mat4x3 b_to_a{1.0f};    // places b in the local space of a, distances of b are exact for similarity transforms only
+    float smooth_radius = 0.0f;  // local space of a
+    bool parallel = true;
+    bool morton_brick_order = false;
+};
+
+/// combines two baked volumes without the meshes, every mip of the result resampled from the same mip of both. The result keeps
+/// the voxel size, brick config and encoding of `a`, over the bounds of both for unions and of `a` otherwise. Bricks with no valid
+/// brick of either volume under them (within `smooth_radius` for smooth unions, whose blend bridges gaps between the volumes) are
+/// skipped, others are resampled and requantized, split bricks come back unsplit.
+/// Beyond the trace distance of a mip distances come from its coarser mips, or are bounded below by the max distance and the side
+/// they tell.
+/// false if a mip of either volume is missing (stopped progressive bake) or the brick config of `a` is not dispatched
+bool combine_distance_fields(DistanceFieldVolumeData const &a, DistanceFieldVolumeData const &b, CsgSettings const &settings,
+                             DistanceFieldVolumeData &out_data);
\ No newline at end of file
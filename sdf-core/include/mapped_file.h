@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+/// read-only memory mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const char *file_path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] bool isValid() const { return data_ != nullptr; }
+    [[nodiscard]] std::string_view view() const { return {data_, size_}; }
+
+private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void *file_handle_ = nullptr;
+    void *mapping_handle_ = nullptr;
+#endif
+};
+
+/// read-write memory mapping of a file created (or truncated) to `size` bytes, disjoint ranges may be written concurrently
+class MappedOutputFile {
+public:
+    MappedOutputFile(const char *file_path, std::size_t size);
+    ~MappedOutputFile();
+
+    MappedOutputFile(const MappedOutputFile &) = delete;
+    MappedOutputFile &operator=(const MappedOutputFile &) = delete;
+
+    [[nodiscard]] bool isValid() const { return data_ != nullptr; }
+    [[nodiscard]] char *data() const { return data_; }
+    [[nodiscard]] std::size_t size() const { return size_; }
+
+private:
+    char *data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void *file_handle_ = nullptr;
+    void *mapping_handle_ = nullptr;
+#endif
+};
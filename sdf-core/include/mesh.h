@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glm/mat4x3.hpp>
+#include <glm/vec3.hpp>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+struct Box {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    [[nodiscard]] glm::vec3 getSize() const { return max - min; }
+    [[nodiscard]] glm::vec3 getExtent() const { return (max - min) * 0.5f; }
+    [[nodiscard]] glm::vec3 getCenter() const { return (max + min) * 0.5f; }
+
+    [[nodiscard]] Box expandBy(glm::vec3 size) const { return {min - size, max + size}; }
+};
+
+/// angle-weighted pseudo-normals of a closed mesh, P is inside iff dot(P - Q, n) < 0 for the normal n of the triangle feature
+/// (face, edge or vertex) holding the closest surface point Q [J. A. Bærentzen, H. Aanæs; 2005; Signed distance computation using
+/// the angle weighted pseudonormal]. Only their direction matters, they are not normalized
+struct MeshPseudoNormals {
+    std::vector<glm::vec3> face_normals;   // per triangle, zero for degenerate ones
+    std::vector<glm::vec3> edge_normals;   // 3 per triangle for edges AB, BC and CA, sum of the normals of the two faces sharing it
+    std::vector<glm::vec3> vertex_normals; // per vertex, angle-weighted sum of the normals around it, coincident vertices share it
+};
+
+struct Mesh {
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::uvec3> indices;
+
+    [[nodiscard]] Box getAABB() const;
+    [[nodiscard]] Box getExpandedBoundingBox() const;
+
+    [[nodiscard]] Mesh translate(glm::vec3 displacement) const;
+
+    /// sub-mesh of the given triangles, only referenced vertices are kept
+    [[nodiscard]] Mesh extractTriangles(std::span<const glm::uint32> triangle_indices) const;
+
+    /// open meshes (foliage cards, cloth) whose boundary is long compared to their surface, sign of distance is meaningless for them
+    [[nodiscard]] bool isMostlyTwoSided() const;
+
+    /// welds vertices within `weld_distance` of an unwelded one (exactly equal ones for 0), drops degenerate and duplicate triangles,
+    /// then sorts triangles along a Morton curve and vertices by first use, for a better BVH and closest point query locality
+    [[nodiscard]] Mesh preprocess(float weld_distance) const;
+
+    /// quadric edge-collapse LODs, one per entry of `max_errors` (non-decreasing, local space), each continuing the collapses of
+    /// the previous one. A collapse is taken only while the summed squared distance to the planes of the triangles it merged stays
+    /// below the squared error, so no LOD vertex strays further than its error from the surface it replaces. Borders stay in place
+    [[nodiscard]] std::vector<Mesh> simplify(std::span<const float> max_errors) const;
+
+    /// nullopt unless the mesh is closed and manifold once coincident vertices are welded: every edge shared by exactly two
+    /// triangles winding it in opposite directions
+    [[nodiscard]] std::optional<MeshPseudoNormals> computePseudoNormals() const;
+
+    /// .ply and .obj go through the native memory-mapped readers unless `b_allow_native_reader` is false,
+    /// everything else (and anything the native readers reject) through Assimp. Empty if the file cannot be read
+    static std::vector<Mesh> importFromFile(const char *file_path, bool b_allow_native_reader = true);
+
+    /// same for the content of a file already in memory, `extension` ("ply", "obj", ...) stands for the file name
+    static std::vector<Mesh> importFromMemory(std::string_view file_data, std::string_view extension, bool b_allow_native_reader = true);
+};
+
+/// placement of a mesh in a multi-mesh bake, instances of the same mesh share its buffers and BVH
+struct MeshInstance {
+    Mesh const *mesh = nullptr;
+    glm::mat4x3 transform{1.0f}; // mesh space to the bake's local space
+
+    [[nodiscard]] Box getAABB() const;
+};
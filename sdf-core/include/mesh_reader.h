@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string_view>
+
+struct Mesh;
+
+/// native readers bypassing Assimp, parsing in parallel straight into `Mesh::vertices/indices`
+/// NOTE: return false when the file uses a layout they do not handle, the caller falls back to Assimp
+
+/// binary (little or big endian) and ascii PLY
+bool read_ply(const char *file_path, Mesh &out_mesh);
+
+/// positions and faces of an OBJ, all groups merged in one mesh
+bool read_obj(const char *file_path, Mesh &out_mesh);
+
+/// same readers on the content of a file already in memory
+bool parse_ply(std::string_view file_data, Mesh &out_mesh);
+bool parse_obj(std::string_view file_data, Mesh &out_mesh);
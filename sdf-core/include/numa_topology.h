@@ -0,0 +1,31 @@
+#pragma once
+
+#include <functional>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+/// logical CPUs of each NUMA node the process may run on
+struct NumaTopology {
+    std::vector<std::vector<glm::uint32>> node_cpus;
+
+    [[nodiscard]] glm::uint32 getNumNodes() const { return glm::uint32(node_cpus.size()); }
+
+    /// nodes reported by the OS, a single node with every CPU where it reports none
+    static NumaTopology detect();
+
+    /// the CPUs of the machine split in `num_nodes` runs of consecutive ids, to try NUMA placement on a single socket.
+    /// With fewer CPUs than nodes, nodes share CPUs
+    static NumaTopology simulate(glm::uint32 num_nodes);
+};
+
+/// restricts the calling thread to `cpus`, false where the OS refuses or has no thread affinity
+bool pin_current_thread(std::span<const glm::uint32> cpus);
+
+/// calls `work(node, item)` for items [0, num_node_items[node]) of every node, on one thread per CPU pinned to the CPUs of its
+/// node. Threads run out of their own node's items first, then help the other nodes. Returns once every item is done
+void run_pinned_per_node(NumaTopology const &topology, std::span<const std::size_t> num_node_items,
+                         std::function<void(glm::uint32 node, std::size_t item)> const &work);
+
+/// calls `work` on a thread pinned to the CPUs of `node` and waits for it, whatever it allocates and fills is first touched there
+void run_pinned_on_node(NumaTopology const &topology, glm::uint32 node, std::function<void()> const &work);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "local_sdf.h"
+
+#include <thread>
+
+/// bakes on a background thread, the always loaded mip first, then finer mips until done, cancelled or out of time
+/// NOTE: `mesh` (or the instanced meshes) is read during the whole bake and must outlive it
+class ProgressiveDistanceFieldBake {
+public:
+    using MipCompleteCallback = std::function<void(DistanceFieldVolumeData const &data, glm::uint32 finest_complete_mip)>;
+
+    ProgressiveDistanceFieldBake(Mesh const &mesh, Box bounds, float distance_field_resolution_scale, bool b_generate_as_if_two_sided,
+                                 BakeSettings const &settings, std::chrono::steady_clock::duration time_budget,
+                                 MipCompleteCallback on_mip_complete = {});
+    ProgressiveDistanceFieldBake(std::span<const MeshInstance> instances, Box bounds, float distance_field_resolution_scale,
+                                 bool b_generate_as_if_two_sided, BakeSettings const &settings,
+                                 std::chrono::steady_clock::duration time_budget, MipCompleteCallback on_mip_complete = {});
+    ~ProgressiveDistanceFieldBake();
+
+    ProgressiveDistanceFieldBake(const ProgressiveDistanceFieldBake &) = delete;
+    ProgressiveDistanceFieldBake &operator=(const ProgressiveDistanceFieldBake &) = delete;
+
+    /// fraction of all bricks of all mips baked so far
+    [[nodiscard]] float getProgress() const;
+    [[nodiscard]] bool isFinished() const { return b_finished_; }
+
+    void cancel() { control_.b_cancelled = true; }
+
+    /// blocks until the bake stops, returns the finest complete mip, NUM_MIPS if none was reached
+    glm::uint32 wait(DistanceFieldVolumeData &out_data);
+
+private:
+    std::vector<MeshInstance> instances_;
+    BakeSettings settings_;
+    DistanceFieldBakeControl control_;
+    DistanceFieldVolumeData result_;
+    std::atomic<bool> b_finished_ = false;
+    std::thread worker_;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "mesh.h"
+
+class DistanceFieldVolumeData;
+
+/// writes `<output_prefix><mip>_color.ply` per mip, or valid/invalid brick point clouds with `debug_brick`, false if a file failed
+bool dump_sdf_volume_for_visualization(DistanceFieldVolumeData const &volume_data, const char *output_prefix, bool debug_brick) noexcept;
+
+/// distance 0 iso-surface of one mip, extracted per valid brick in parallel and welded across brick borders, empty for unbaked mips
+Mesh extract_sdf_iso_surface(DistanceFieldVolumeData const &volume_data, glm::uint32 mip_index);
+
+/// writes the iso-surface of every baked mip to `<output_prefix><mip>_surface.ply`
+bool dump_sdf_iso_surface(DistanceFieldVolumeData const &volume_data, const char *output_prefix) noexcept;
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+glm::dvec3 closest_point_on_segment(glm::dvec3 const &P, glm::dvec3 const &start, glm::dvec3 const &end);
+glm::dvec3 closest_point_on_triangle(glm::dvec3 const &P, glm::dvec3 const &A, glm::dvec3 const &B, glm::dvec3 const &C);
+
+/// voronoi region of a triangle the closest point lies in
+enum class TriangleFeature : std::uint8_t { vertex_a, vertex_b, vertex_c, edge_ab, edge_bc, edge_ca, face };
+
+/// same, also telling which feature the closest point is on
+glm::dvec3 closest_point_on_triangle(glm::dvec3 const &P, glm::dvec3 const &A, glm::dvec3 const &B, glm::dvec3 const &C,
+                                     TriangleFeature &out_feature);
+
+class Plane {
+public:
+    Plane(glm::dvec3 const &point, glm::dvec3 const &normal);
+    Plane(glm::dvec3 const &A, glm::dvec3 const &B, glm::dvec3 const &C);
+
+    double planeDot(glm::dvec3 const &point);
+    glm::dvec3 pointProjection(glm::dvec3 const &point);
+
+private:
+    glm::dvec3 plane_point_;
+    glm::dvec3 normal_;
+};
+
+/// brute-force unsigned distance from a batch of points to a small triangle soup,
+/// branch-free per point so the inner loop auto-vectorizes
+class TriangleSoupDistance {
+public:
+    /// 3 vertices per triangle
+    explicit TriangleSoupDistance(std::span<const glm::vec3> triangle_vertices);
+
+    /// points in SoA layout, keeps the minimum of `in_out_distance_sq` and the squared distance to every triangle
+    void minDistanceSquared(std::span<const float> xs, std::span<const float> ys, std::span<const float> zs,
+                            std::span<float> in_out_distance_sq) const;
+
+    /// same, also updating `in_out_closest_triangle` with the index of the triangle each new minimum comes from
+    void minDistanceSquared(std::span<const float> xs, std::span<const float> ys, std::span<const float> zs,
+                            std::span<float> in_out_distance_sq, std::span<std::uint32_t> in_out_closest_triangle) const;
+
+private:
+    template <bool b_track_closest>
+    void minDistanceSquared(std::span<const float> xs, std::span<const float> ys, std::span<const float> zs,
+                            std::span<float> in_out_distance_sq, std::span<std::uint32_t> in_out_closest_triangle) const;
+
+    struct Triangle {
+        glm::vec3 A, B, C;
+        glm::vec3 BA, CB, AC;
+        glm::vec3 BA_side, CB_side, AC_side; // in-plane edge normals
+        glm::vec3 normal;
+        float inv_BA_sq, inv_CB_sq, inv_AC_sq, inv_normal_sq;
+    };
+
+    std::vector<Triangle> triangles_;
+};
+
+/// interleaves the low 21 bits of each coordinate, x in the lowest bit
+std::uint64_t morton_encode(glm::uvec3 cell);
+
+/// sizes of the precomputed direction tables
+constexpr std::array<std::uint32_t, 5> SPHERE_DIRECTION_COUNTS = {16, 32, 48, 64, 96};
+
+/// low-discrepancy directions over the whole sphere, baked into compile-time tables so every bake traces the same rays.
+/// \return the smallest table with at least `num_directions`, the largest one for more
+std::span<const glm::vec3> fibonacci_sphere_directions(std::uint32_t num_directions);
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "local_sdf.h"
+#include "mesh.h"
+
+#include <glm/vec2.hpp>
+#include <optional>
+#include <vector>
+
+/// unsplit entry of an indirection table, split bricks are replaced by their children
+struct DistanceFieldMipBrick {
+    glm::uint32 brick_index; // INVALID_BRICK_INDEX for entries without a brick
+    glm::uvec3 coordinate;   // in bricks of its level
+    glm::uint32 level;       // 0 for the indirection dimensions, each split halves the brick size
+};
+
+/// read-only view of one baked mip inside the volume data blobs
+struct DistanceFieldMipView {
+    glm::uvec3 dimensions;
+    const glm::uint32 *indirection_table; // indirection dimensions, then the child blocks of split bricks
+    const glm::uint8 *brick_data;
+    const glm::vec2 *brick_scale_bias; // null for encodings without one
+    DistanceField::Encoding encoding;
+    DistanceField::BrickConfig brick_config;
+    glm::vec3 voxel_size; // between two samples of a brick
+    Box volume_bounds;    // sample (0, 0, 0) of brick (0, 0, 0) sits on the min corner
+    glm::vec2 distance_field_to_volume_scale_bias;
+
+    /// nullopt for mips not reached by a stopped progressive bake
+    static std::optional<DistanceFieldMipView> create(DistanceFieldVolumeData const &volume_data, glm::uint32 mip_index);
+
+    /// normalized distance of a voxel, 0 at -trace distance and 1 at +trace distance
+    [[nodiscard]] float getVoxel(glm::uint32 brick_index, glm::uint32 voxel_index) const {
+        const glm::uint8 *brick = brick_data + std::size_t(brick_index) * DistanceField::get_brick_size_bytes(encoding, brick_config);
+        return DistanceField::decode_voxel(brick, voxel_index, encoding,
+                                           brick_scale_bias ? brick_scale_bias[brick_index] : glm::vec2{1.0f, 0.0f});
+    }
+
+    /// every unsplit entry, depth first in indirection order
+    [[nodiscard]] std::vector<DistanceFieldMipBrick> getBricks() const;
+};
+
+/// CPU counterpart of the sparse distance field lookup: indirection table, then trilinear filtering inside the brick
+class DistanceFieldSampler {
+public:
+    DistanceFieldSampler(DistanceFieldMipView const &mip, Box const &local_space_mesh_bounds);
+
+    /// local space distance, the max encoded distance away from valid bricks
+    [[nodiscard]] float sample(glm::vec3 local_position) const;
+
+private:
+    DistanceFieldMipView mip_;
+    float volume_to_local_scale_;
+};
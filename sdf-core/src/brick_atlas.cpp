@@ -0,0 +1,238 @@
+#include "brick_atlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+BrickAtlas::BrickAtlas(BrickAtlasSettings const &settings)
+    : encoding_{settings.encoding}, brick_config_{settings.brick_config},
+      brick_size_bytes_{DistanceField::get_brick_size_bytes(settings.encoding, settings.brick_config)},
+      num_slots_{(glm::uint32) std::min<std::size_t>(settings.memory_budget / brick_size_bytes_, DistanceField::INVALID_BRICK_INDEX)} {
+    pool_.resize(std::size_t(num_slots_) * brick_size_bytes_);
+    slot_scale_bias_.resize(num_slots_, glm::vec2{1.0f, 0.0f});
+
+    // popped from the back, hand out low slots first
+    free_slots_.resize(num_slots_);
+    for (glm::uint32 i = 0; i < num_slots_; ++i) free_slots_[i] = num_slots_ - 1 - i;
+
+    for (glm::uint32 i = 0; i < std::max(settings.num_io_threads, 1u); ++i) {
+        io_threads_.emplace_back([this] { ioThreadMain(); });
+    }
+}
+
+BrickAtlas::~BrickAtlas() {
+    {
+        std::lock_guard lock{queue_mutex_};
+        b_stopping_ = true;
+    }
+    queue_condition_.notify_all();
+    for (auto &io_thread : io_threads_) io_thread.join();
+}
+
+void BrickAtlas::ioThreadMain() {
+    while (true) {
+        LoadRequest request;
+        {
+            std::unique_lock lock{queue_mutex_};
+            queue_condition_.wait(lock, [this] { return b_stopping_ || !load_queue_.empty(); });
+            if (b_stopping_) return;
+
+            request = std::move(load_queue_.front());
+            load_queue_.pop_front();
+        }
+
+        LoadResult result{request.asset_id, request.mip_index, std::vector<glm::uint8>(request.size), false};
+        std::ifstream file{request.file_path, std::ios_base::binary};
+        file.seekg((std::streamoff) request.file_offset);
+        file.read(reinterpret_cast<char *>(result.mip_data.data()), (std::streamsize) request.size);
+        result.b_success = bool(file);
+
+        std::lock_guard lock{queue_mutex_};
+        finished_loads_.push_back(std::move(result));
+    }
+}
+
+std::optional<BrickAtlas::AssetId> BrickAtlas::registerAsset(const char *file_path) {
+    std::ifstream file{file_path, std::ios_base::binary};
+    if (!file) return std::nullopt;
+
+    auto asset = std::make_unique<Asset>();
+    asset->file_path = file_path;
+    if (!DistanceFieldVolumeData::deserializeHeader(file, asset->header)) return std::nullopt;
+    if (asset->header.encoding != encoding_ || asset->header.brick_config != brick_config_) return std::nullopt;
+
+    // streamable blob follows as a size and its bytes, only remember where
+    std::uint32_t streamable_mips_size = 0;
+    file.read(reinterpret_cast<char *>(&streamable_mips_size), sizeof(streamable_mips_size));
+    if (!file) return std::nullopt;
+    asset->streamable_mips_offset = (std::uint64_t) file.tellg();
+
+    const AssetId asset_id = (AssetId) assets_.size();
+    assets_.push_back(std::move(asset));
+
+    constexpr glm::uint32 always_loaded_mip_index = DistanceField::NUM_MIPS - 1;
+    Asset &registered_asset = *assets_.back();
+    registered_asset.mips[always_loaded_mip_index].b_pinned = true;
+
+    std::vector<glm::uint8> always_loaded_mip = std::move(registered_asset.header.always_loaded_mip);
+    if (!makeResident(asset_id, always_loaded_mip_index, always_loaded_mip)) {
+        assets_.pop_back();
+        return std::nullopt;
+    }
+
+    return asset_id;
+}
+
+void BrickAtlas::requestMip(AssetId asset_id, glm::uint32 mip_index) {
+    Asset &asset = *assets_[asset_id];
+    asset.requested_mip = std::min(asset.requested_mip, mip_index);
+
+    for (glm::uint32 i = mip_index; i < DistanceField::NUM_MIPS; ++i) asset.mips[i].last_requested_update = update_index_;
+}
+
+void BrickAtlas::update() {
+    std::vector<LoadResult> finished_loads;
+    {
+        std::lock_guard lock{queue_mutex_};
+        finished_loads.swap(finished_loads_);
+    }
+
+    for (LoadResult const &load : finished_loads) {
+        --num_pending_loads_;
+        ResidentMip &mip = assets_[load.asset_id]->mips[load.mip_index];
+        mip.b_loading = false;
+
+        // a load finishing for a mip nobody asked for since the last update is dropped, failed ones are retried on request
+        if (load.b_success && mip.last_requested_update >= update_index_) makeResident(load.asset_id, load.mip_index, load.mip_data);
+    }
+
+    std::vector<LoadRequest> new_loads;
+    for (AssetId asset_id = 0; asset_id < assets_.size(); ++asset_id) {
+        Asset &asset = *assets_[asset_id];
+
+        for (glm::uint32 mip_index = asset.requested_mip; mip_index + 1 < DistanceField::NUM_MIPS; ++mip_index) {
+            ResidentMip &mip = asset.mips[mip_index];
+            if (!mip.indirection_table.empty() || mip.b_loading) continue;
+            if (mip.out_of_slots_evictions == num_evictions_) continue; // would not fit any better than last time
+
+            SparseDistanceFieldMip const &mip_info = asset.header.mips[mip_index];
+            mip.b_loading = true;
+            new_loads.push_back(
+                {asset_id, mip_index, asset.file_path, asset.streamable_mips_offset + mip_info.bulk_offset, mip_info.bulk_size});
+        }
+
+        asset.requested_mip = DistanceField::NUM_MIPS - 1;
+    }
+
+    if (!new_loads.empty()) {
+        num_pending_loads_ += new_loads.size();
+        {
+            std::lock_guard lock{queue_mutex_};
+            std::move(new_loads.begin(), new_loads.end(), std::back_inserter(load_queue_));
+        }
+        queue_condition_.notify_all();
+    }
+
+    ++update_index_;
+}
+
+bool BrickAtlas::makeResident(AssetId asset_id, glm::uint32 mip_index, std::span<const glm::uint8> mip_data) {
+    SparseDistanceFieldMip const &mip_info = assets_[asset_id]->header.mips[mip_index];
+    const std::size_t indirection_table_size = mip_info.getIndirectionTableSize();
+    const std::size_t indirection_table_bytes = indirection_table_size * sizeof(glm::uint32);
+
+    const std::size_t brick_data_bytes = std::size_t(mip_info.num_distance_field_bricks) * brick_size_bytes_;
+    const std::size_t brick_scale_bias_bytes =
+        DistanceField::has_brick_scale_bias(encoding_) ? std::size_t(mip_info.num_distance_field_bricks) * sizeof(glm::vec2) : 0;
+
+    if (indirection_table_size == 0 || mip_data.size() != indirection_table_bytes + brick_data_bytes + brick_scale_bias_bytes) {
+        return false;
+    }
+
+    ResidentMip &mip = assets_[asset_id]->mips[mip_index];
+    if (!reserveSlots(mip_info.num_distance_field_bricks)) {
+        mip.out_of_slots_evictions = num_evictions_;
+        return false;
+    }
+    mip.out_of_slots_evictions.reset();
+
+    mip.indirection_table.resize(indirection_table_size);
+    std::memcpy(mip.indirection_table.data(), mip_data.data(), indirection_table_bytes);
+
+    const glm::uint8 *brick_data = mip_data.data() + indirection_table_bytes;
+    const glm::uint8 *brick_scale_bias = brick_data + brick_data_bytes;
+    mip.slots.resize(mip_info.num_distance_field_bricks);
+    for (glm::uint32 &slot : mip.slots) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    }
+
+    for (glm::uint32 &entry : mip.indirection_table) {
+        // no brick, or the child block offset of a split brick which stays valid
+        if (entry == DistanceField::INVALID_BRICK_INDEX || DistanceField::is_refined_entry(entry)) continue;
+
+        const glm::uint32 slot = mip.slots[entry];
+        std::memcpy(pool_.data() + std::size_t(slot) * brick_size_bytes_, brick_data + std::size_t(entry) * brick_size_bytes_,
+                    brick_size_bytes_);
+        if (brick_scale_bias_bytes != 0) {
+            std::memcpy(&slot_scale_bias_[slot], brick_scale_bias + std::size_t(entry) * sizeof(glm::vec2), sizeof(glm::vec2));
+        }
+        entry = slot;
+    }
+
+    return true;
+}
+
+void BrickAtlas::evict(ResidentMip &mip) {
+    free_slots_.insert(free_slots_.end(), mip.slots.rbegin(), mip.slots.rend());
+    std::vector<glm::uint32>{}.swap(mip.slots);
+    std::vector<glm::uint32>{}.swap(mip.indirection_table);
+    ++num_evictions_;
+}
+
+bool BrickAtlas::reserveSlots(std::size_t num_slots) {
+    while (free_slots_.size() < num_slots) {
+        // least recently requested mip among those not asked for since the last update
+        ResidentMip *victim = nullptr;
+        for (auto &asset : assets_) {
+            for (ResidentMip &mip : asset->mips) {
+                if (mip.b_pinned || mip.indirection_table.empty() || mip.last_requested_update >= update_index_) continue;
+                if (!victim || mip.last_requested_update < victim->last_requested_update) victim = &mip;
+            }
+        }
+
+        if (!victim) return false;
+        evict(*victim);
+    }
+
+    return true;
+}
+
+glm::uint32 BrickAtlas::getFinestResidentMip(AssetId asset_id) const {
+    Asset const &asset = *assets_[asset_id];
+    for (glm::uint32 mip_index = 0; mip_index < DistanceField::NUM_MIPS; ++mip_index) {
+        if (!asset.mips[mip_index].indirection_table.empty()) return mip_index;
+    }
+    return DistanceField::NUM_MIPS - 1;
+}
+
+bool BrickAtlas::isMipOutOfSlots(AssetId asset_id, glm::uint32 mip_index) const {
+    return assets_[asset_id]->mips[mip_index].out_of_slots_evictions == num_evictions_;
+}
+
+std::span<const glm::uint32> BrickAtlas::getIndirectionTable(AssetId asset_id, glm::uint32 mip_index) const {
+    return assets_[asset_id]->mips[mip_index].indirection_table;
+}
+
+SparseDistanceFieldMip const &BrickAtlas::getMipInfo(AssetId asset_id, glm::uint32 mip_index) const {
+    return assets_[asset_id]->header.mips[mip_index];
+}
+
+glm::uvec3 BrickAtlas::getSlotCoordinate(glm::uint32 slot) const {
+    return {
+        slot % POOL_WIDTH_IN_BRICKS,
+        slot / POOL_WIDTH_IN_BRICKS % POOL_WIDTH_IN_BRICKS,
+        slot / POOL_WIDTH_IN_BRICKS / POOL_WIDTH_IN_BRICKS,
+    };
+}
@@ -0,0 +1,456 @@
+#include "embree_wrapper.h"
+#include "mesh.h"
+#include "sdf_math.h"
+#include <algorithm>
+#include <execution>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+
+namespace embree {
+
+namespace {
+
+/// scene geometry a point query callback runs for, the instance for instanced triangles
+glm::uint32 get_scene_geom_id(RTCPointQueryFunctionArguments const *args) {
+    return args->context->instStackSize > 0 ? args->context->instID[0] : args->geomID;
+}
+
+} // namespace
+
+RTCDevice get_shared_device() {
+    // TODO: error handling
+    static const RTCDevice device = rtcNewDevice(nullptr);
+    return device;
+}
+
+RTCDevice new_calling_thread_device() {
+    return rtcNewDevice("threads=1,set_affinity=0");
+}
+
+Scene::Scene(RTCDevice device) {
+    device_ = device;
+    rtcRetainDevice(device_);
+    scene_ = rtcNewScene(device_);
+    rtcSetSceneFlags(scene_, RTC_SCENE_FLAG_NONE);
+}
+
+Scene::~Scene() {
+    rtcReleaseScene(scene_);
+    for (auto &prototype : prototypes_) rtcReleaseScene(prototype.scene);
+    rtcReleaseDevice(device_);
+}
+
+void Scene::addMesh(Mesh const &mesh, MeshPseudoNormals const *pseudo_normals) {
+    RTCGeometry geo_handle = rtcNewGeometry(device_, RTC_GEOMETRY_TYPE_TRIANGLE);
+
+    rtcSetSharedGeometryBuffer(geo_handle, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3, mesh.vertices.data(), 0, sizeof(glm::vec3),
+                               mesh.vertices.size());
+    rtcSetSharedGeometryBuffer(geo_handle, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3, mesh.indices.data(), 0, sizeof(glm::uvec3),
+                               mesh.indices.size());
+
+    geos_.emplace_back(mesh.indices, mesh.vertices, geo_handle, pseudo_normals);
+}
+
+glm::uint32 Scene::addPrototype(Mesh const &mesh, MeshPseudoNormals const *pseudo_normals) {
+    RTCGeometry geo_handle = rtcNewGeometry(device_, RTC_GEOMETRY_TYPE_TRIANGLE);
+
+    rtcSetSharedGeometryBuffer(geo_handle, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3, mesh.vertices.data(), 0, sizeof(glm::vec3),
+                               mesh.vertices.size());
+    rtcSetSharedGeometryBuffer(geo_handle, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3, mesh.indices.data(), 0, sizeof(glm::uvec3),
+                               mesh.indices.size());
+    rtcCommitGeometry(geo_handle);
+
+    RTCScene prototype_scene = rtcNewScene(device_);
+    rtcAttachGeometry(prototype_scene, geo_handle);
+    rtcReleaseGeometry(geo_handle);
+    rtcJoinCommitScene(prototype_scene);
+
+    prototypes_.push_back({{mesh.indices, mesh.vertices, geo_handle, pseudo_normals}, prototype_scene});
+    return glm::uint32(prototypes_.size() - 1);
+}
+
+void Scene::addInstance(glm::uint32 prototype_index, glm::mat4x3 const &local_to_world) {
+    assert(prototype_index < prototypes_.size());
+
+    RTCGeometry instance_handle = rtcNewGeometry(device_, RTC_GEOMETRY_TYPE_INSTANCE);
+    rtcSetGeometryInstancedScene(instance_handle, prototypes_[prototype_index].scene);
+    rtcSetGeometryTransform(instance_handle, 0, RTC_FORMAT_FLOAT3X4_COLUMN_MAJOR, &local_to_world[0][0]);
+
+    const glm::mat3 linear_part{local_to_world};
+    const glm::mat3 inverse_linear_part = glm::inverse(linear_part);
+    const glm::mat4x3 world_to_local{inverse_linear_part[0], inverse_linear_part[1], inverse_linear_part[2],
+                                     -(inverse_linear_part * local_to_world[3])};
+
+    // columns orthogonal and of equal length
+    const glm::mat3 gram = glm::transpose(linear_part) * linear_part;
+    const float similarity_epsilon = 1e-4f * gram[0][0];
+    bool b_similarity = true;
+    for (glm::uint32 i = 0; i < 3; ++i) {
+        for (glm::uint32 j = 0; j < 3; ++j) {
+            b_similarity = b_similarity && std::abs(gram[i][j] - (i == j ? gram[0][0] : 0.0f)) <= similarity_epsilon;
+        }
+    }
+
+    instances_.push_back({prototype_index, local_to_world, world_to_local, glm::transpose(inverse_linear_part),
+                          glm::determinant(linear_part) < 0.0f, b_similarity, instance_handle});
+}
+
+void Scene::commit() {
+    for (auto &geo : geos_) {
+        rtcSetGeometryUserData(geo.handle, &geo);
+
+        rtcCommitGeometry(geo.handle);
+        rtcAttachGeometry(scene_, geo.handle);
+        rtcReleaseGeometry(geo.handle);
+    }
+    for (auto &instance : instances_) {
+        rtcCommitGeometry(instance.handle);
+        rtcAttachGeometry(scene_, instance.handle);
+        rtcReleaseGeometry(instance.handle);
+    }
+    rtcJoinCommitScene(scene_);
+}
+
+std::array<glm::vec3, 3> Scene::getTriangle(glm::uint32 geom_id, glm::uint32 prim_id) const {
+    if (geom_id < geos_.size()) {
+        Geometry const &geo = geos_[geom_id];
+        const glm::uvec3 triangle = geo.indices_buffer[prim_id];
+        return {geo.vertices_buffer[triangle.x], geo.vertices_buffer[triangle.y], geo.vertices_buffer[triangle.z]};
+    }
+
+    Instance const &instance = instances_[geom_id - geos_.size()];
+    Geometry const &geo = prototypes_[instance.prototype_index].geometry;
+    glm::uvec3 triangle = geo.indices_buffer[prim_id];
+    if (instance.b_mirrored) std::swap(triangle.y, triangle.z);
+    return {
+        instance.local_to_world * glm::vec4(geo.vertices_buffer[triangle.x], 1.0f),
+        instance.local_to_world * glm::vec4(geo.vertices_buffer[triangle.y], 1.0f),
+        instance.local_to_world * glm::vec4(geo.vertices_buffer[triangle.z], 1.0f),
+    };
+}
+
+std::optional<bool> Scene::isInsideAt(glm::vec3 point, glm::uint32 geom_id, glm::uint32 prim_id) const {
+    // in the mesh's own space, where its pseudo-normals are. A similarity keeps the closest feature and maps the inside to the
+    // inside, mirrored or not
+    Geometry const *geo = nullptr;
+    glm::dvec3 P = point;
+    if (geom_id < geos_.size()) {
+        geo = &geos_[geom_id];
+    } else {
+        Instance const &instance = instances_[geom_id - geos_.size()];
+        if (!instance.b_similarity) return std::nullopt;
+        geo = &prototypes_[instance.prototype_index].geometry;
+        P = instance.world_to_local * glm::vec4(point, 1.0f);
+    }
+    if (!geo->pseudo_normals) return std::nullopt;
+
+    const glm::uvec3 triangle = geo->indices_buffer[prim_id];
+    TriangleFeature feature;
+    const glm::dvec3 closest_point = closest_point_on_triangle(P, geo->vertices_buffer[triangle.x], geo->vertices_buffer[triangle.y],
+                                                               geo->vertices_buffer[triangle.z], feature);
+
+    MeshPseudoNormals const &pseudo_normals = *geo->pseudo_normals;
+    glm::vec3 pseudo_normal;
+    switch (feature) {
+    case TriangleFeature::vertex_a: pseudo_normal = pseudo_normals.vertex_normals[triangle.x]; break;
+    case TriangleFeature::vertex_b: pseudo_normal = pseudo_normals.vertex_normals[triangle.y]; break;
+    case TriangleFeature::vertex_c: pseudo_normal = pseudo_normals.vertex_normals[triangle.z]; break;
+    case TriangleFeature::edge_ab: pseudo_normal = pseudo_normals.edge_normals[prim_id * 3 + 0]; break;
+    case TriangleFeature::edge_bc: pseudo_normal = pseudo_normals.edge_normals[prim_id * 3 + 1]; break;
+    case TriangleFeature::edge_ca: pseudo_normal = pseudo_normals.edge_normals[prim_id * 3 + 2]; break;
+    case TriangleFeature::face: pseudo_normal = pseudo_normals.face_normals[prim_id]; break;
+    }
+
+    // zero on the surface, or for the normal of a degenerate triangle
+    const double side = glm::dot(P - closest_point, glm::dvec3(pseudo_normal));
+    if (side == 0) return std::nullopt;
+    return side < 0;
+}
+
+RayHit IntersectionContext::emitRay(glm::vec3 const &origin, glm::vec3 const &direction, float far) {
+    RayHit rayhit{origin, direction, far};
+    emitRay(&rayhit);
+    return rayhit;
+}
+
+void IntersectionContext::emitRay(RayHit *rayhit) {
+    rtcIntersect1(scene_.scene_, rayhit, this);
+
+    // embree reports instanced hits in object space with the prototype's geometry id
+    if (rayhit->hit.instID[0] != RTC_INVALID_GEOMETRY_ID && rayhit->hit.geomID != RTC_INVALID_GEOMETRY_ID) {
+        Instance const &instance = scene_.instances_[rayhit->hit.instID[0] - scene_.geos_.size()];
+        const glm::vec3 world_normal = instance.normal_to_world * glm::vec3{rayhit->hit.Ng_x, rayhit->hit.Ng_y, rayhit->hit.Ng_z};
+        rayhit->hit.Ng_x = world_normal.x;
+        rayhit->hit.Ng_y = world_normal.y;
+        rayhit->hit.Ng_z = world_normal.z;
+        rayhit->hit.geomID = rayhit->hit.instID[0];
+    }
+}
+
+bool IntersectionContext::isInside(glm::vec3 const &origin, std::span<const glm::vec3> directions, float far) {
+    glm::uint32 hit_back_count = 0;
+
+    for (const glm::vec3 unit_ray_direction : directions) {
+        const float pullback_epsilon = 1e-4f;
+        const glm::vec3 start_pos = origin - pullback_epsilon * far * unit_ray_direction;
+
+        // TODO: test ray intersect with bounding first
+        RayHit rayhit = emitRay(start_pos, unit_ray_direction, far);
+
+        if (rayhit.isValidHit()) {
+            const glm::vec3 hit_normal = rayhit.getHitNormal();
+            if (glm::dot(unit_ray_direction, hit_normal) > 0) {
+                hit_back_count++;
+            }
+        }
+    }
+
+    // consider it inside if significant ray hit back
+    return hit_back_count != 0 && hit_back_count > directions.size() / 4;
+}
+
+RayHit::RayHit(glm::vec3 const &origin, glm::vec3 const &direction, float far) {
+    hit.u = hit.v = 0;
+    ray.time = 0;
+    ray.mask = 0xFFFFFFFF;
+
+    ray.tnear = 0;
+    ray.tfar = far;
+
+    hit.geomID = RTC_INVALID_GEOMETRY_ID;
+    hit.instID[0] = RTC_INVALID_GEOMETRY_ID;
+    hit.primID = RTC_INVALID_GEOMETRY_ID;
+
+    ray.org_x = origin.x;
+    ray.org_y = origin.y;
+    ray.org_z = origin.z;
+
+    ray.dir_x = direction.x;
+    ray.dir_y = direction.y;
+    ray.dir_z = direction.z;
+}
+
+glm::vec3 RayHit::getHitNormal() const {
+    const glm::vec3 hit_vec = {hit.Ng_x, hit.Ng_y, hit.Ng_z};
+
+    const float unsafe_normal_epsilon = 1e-16f;
+    if (glm::dot(hit_vec, hit_vec) < unsafe_normal_epsilon) {
+        return {0, 0, 0};
+    }
+
+    return glm::normalize(hit_vec);
+}
+
+/// private class
+class PointQuery : public RTCPointQuery {
+public:
+    PointQuery(glm::vec3 const &center, float r) {
+        time = 0;
+        x = center.x;
+        y = center.y;
+        z = center.z;
+        radius = r;
+    }
+};
+
+ClosestQueryContext::ClosestQueryContext(Scene const &scene) : scene_{scene} {
+    rtcInitPointQueryContext(this);
+}
+
+float ClosestQueryResult::getDistance() const {
+    return std::sqrt(query_distance_sq);
+}
+
+bool ClosestQueryContext::closestQueryFunc(RTCPointQueryFunctionArguments *args) {
+    const auto *context = reinterpret_cast<const ClosestQueryContext *>(args->context);
+
+    assert(args->userPtr);
+    ClosestQueryResult &closest_query = *reinterpret_cast<ClosestQueryResult *>(args->userPtr);
+
+    const std::uint32_t mesh_index = get_scene_geom_id(args);
+    const std::uint32_t triangle_index = args->primID;
+
+    // everything is compared in world space, inside an instance args->query may be in its space
+    const auto [V0, V1, V2] = context->scene_.getTriangle(mesh_index, triangle_index);
+
+    const glm::vec3 query_position = closest_query.query_position;
+
+    const glm::vec3 closest_point = closest_point_on_triangle(query_position, V0, V1, V2);
+    const float query_distance_sq = glm::dot(closest_point - query_position, closest_point - query_position);
+
+    if (query_distance_sq < closest_query.query_distance_sq) {
+        closest_query.query_distance_sq = query_distance_sq;
+        closest_query.closest_point = closest_point;
+        closest_query.geom_id = mesh_index;
+        closest_query.prim_id = triangle_index;
+
+        bool b_shrink_query = true;
+
+        if (b_shrink_query) {
+            // similarity transforms carry the query into instance space, scaled by `similarityScale`
+            const float radius_scale = args->similarityScale > 0 ? args->similarityScale : 1.0f;
+            args->query->radius = std::sqrt(query_distance_sq) * radius_scale;
+            // Return true to indicate that the query radius has shrunk
+            return true;
+        }
+    }
+
+    // Return false to indicate that the query radius hasn't changed
+    return false;
+}
+
+ClosestQueryResult ClosestQueryContext::query(glm::vec3 center, float radius) {
+    PointQuery point_query{center, radius};
+    ClosestQueryResult closest_query;
+    closest_query.query_position = center;
+    closest_query.query_distance_sq = radius * radius;
+
+    rtcPointQuery(scene_.scene_, &point_query, this, closestQueryFunc, &closest_query);
+
+    return closest_query;
+}
+
+namespace {
+
+/// points of a batched query sharing one set of contexts
+constexpr std::size_t MESH_QUERY_CHUNK_SIZE = 256;
+
+/// weights of B and C for a point on the triangle [C. Ericson; 2005; Real-Time Collision Detection, 3.4]
+glm::vec2 triangle_barycentrics(glm::vec3 const &P, glm::vec3 const &A, glm::vec3 const &B, glm::vec3 const &C) {
+    const glm::vec3 AB = B - A;
+    const glm::vec3 AC = C - A;
+    const glm::vec3 AP = P - A;
+
+    const float d00 = glm::dot(AB, AB);
+    const float d01 = glm::dot(AB, AC);
+    const float d11 = glm::dot(AC, AC);
+    const float d20 = glm::dot(AP, AB);
+    const float d21 = glm::dot(AP, AC);
+
+    const float denom = d00 * d11 - d01 * d01;
+    if (denom <= 0) return {0, 0}; // zero-area triangle, any vertex is as good
+    return {(d11 * d20 - d01 * d21) / denom, (d00 * d21 - d01 * d20) / denom};
+}
+
+} // namespace
+
+void Scene::queryClosest(std::span<const glm::vec3> points, MeshQuerySettings const &settings,
+                         std::span<MeshQueryResult> out_results) const {
+    assert(points.size() == out_results.size());
+
+    const std::span<const glm::vec3> sign_directions =
+        settings.b_signed ? fibonacci_sphere_directions(settings.num_sign_rays) : std::span<const glm::vec3>{};
+
+    // sign rays need an end, past the scene they find nothing anyway
+    float sign_trace_distance = settings.max_distance;
+    if (settings.b_signed && !std::isfinite(sign_trace_distance)) {
+        RTCBounds bounds;
+        rtcGetSceneBounds(scene_, &bounds);
+        sign_trace_distance = glm::length(glm::vec3(bounds.upper_x - bounds.lower_x, bounds.upper_y - bounds.lower_y,
+                                                    bounds.upper_z - bounds.lower_z));
+    }
+
+    std::vector<std::size_t> chunk_begins;
+    for (std::size_t begin = 0; begin < points.size(); begin += MESH_QUERY_CHUNK_SIZE) chunk_begins.push_back(begin);
+
+    auto query_chunk = [&](std::size_t chunk_begin) {
+        ClosestQueryContext point_query{*this};
+        IntersectionContext intersect{*this};
+
+        const std::size_t chunk_end = std::min(chunk_begin + MESH_QUERY_CHUNK_SIZE, points.size());
+        for (std::size_t i = chunk_begin; i < chunk_end; ++i) {
+            const ClosestQueryResult closest = point_query.query(points[i], settings.max_distance);
+            MeshQueryResult &result = out_results[i];
+
+            result = MeshQueryResult{};
+            result.distance = settings.max_distance;
+            if (closest.geom_id == RTC_INVALID_GEOMETRY_ID) continue;
+
+            const auto [V0, V1, V2] = getTriangle(closest.geom_id, closest.prim_id);
+
+            const glm::vec3 face_normal = glm::cross(V1 - V0, V2 - V0);
+            const float face_normal_length = glm::length(face_normal);
+
+            result.closest_point = closest.closest_point;
+            result.normal = face_normal_length > 0 ? face_normal / face_normal_length : glm::vec3(0);
+            result.barycentrics = triangle_barycentrics(closest.closest_point, V0, V1, V2);
+            result.distance = closest.getDistance();
+            result.geom_id = closest.geom_id;
+            result.prim_id = closest.prim_id;
+
+            if (settings.b_signed) {
+                const std::optional<bool> b_inside = isInsideAt(points[i], closest.geom_id, closest.prim_id);
+                if (b_inside ? *b_inside : intersect.isInside(points[i], sign_directions, sign_trace_distance)) {
+                    result.distance = -result.distance;
+                }
+            }
+        }
+    };
+
+    if (settings.parallel) {
+        std::for_each(std::execution::par, chunk_begins.begin(), chunk_begins.end(), query_chunk);
+    } else {
+        std::for_each(chunk_begins.begin(), chunk_begins.end(), query_chunk);
+    }
+}
+
+namespace {
+
+struct OverlapQueryResult {
+    glm::vec3 bounds_min;
+    glm::vec3 bounds_max;
+    std::size_t max_triangles;
+    std::vector<glm::vec3> &triangle_vertices;
+    std::vector<glm::uvec2> *triangle_ids;
+    bool b_overflow = false;
+};
+
+} // namespace
+
+OverlapQueryContext::OverlapQueryContext(Scene const &scene) : scene_{scene} {
+    rtcInitPointQueryContext(this);
+}
+
+bool OverlapQueryContext::overlapQueryFunc(RTCPointQueryFunctionArguments *args) {
+    const auto *context = reinterpret_cast<const OverlapQueryContext *>(args->context);
+
+    assert(args->userPtr);
+    OverlapQueryResult &overlap_query = *reinterpret_cast<OverlapQueryResult *>(args->userPtr);
+
+    if (overlap_query.b_overflow) return false;
+
+    const glm::uint32 geom_id = get_scene_geom_id(args);
+    const auto [V0, V1, V2] = context->scene_.getTriangle(geom_id, args->primID);
+
+    // embree only culls against the bounding sphere of the box
+    const glm::vec3 triangle_min = glm::min(V0, glm::min(V1, V2));
+    const glm::vec3 triangle_max = glm::max(V0, glm::max(V1, V2));
+    if (triangle_min.x > overlap_query.bounds_max.x || triangle_min.y > overlap_query.bounds_max.y ||
+        triangle_min.z > overlap_query.bounds_max.z || triangle_max.x < overlap_query.bounds_min.x ||
+        triangle_max.y < overlap_query.bounds_min.y || triangle_max.z < overlap_query.bounds_min.z) {
+        return false;
+    }
+
+    if (overlap_query.triangle_vertices.size() >= overlap_query.max_triangles * 3) {
+        overlap_query.b_overflow = true;
+        // shrink to nothing so the rest of the traversal is culled
+        args->query->radius = 0;
+        return true;
+    }
+
+    overlap_query.triangle_vertices.insert(overlap_query.triangle_vertices.end(), {V0, V1, V2});
+    if (overlap_query.triangle_ids) overlap_query.triangle_ids->emplace_back(geom_id, args->primID);
+    return false;
+}
+
+bool OverlapQueryContext::query(Box const &bounds, std::size_t max_triangles, std::vector<glm::vec3> &out_triangle_vertices,
+                                std::vector<glm::uvec2> *out_triangle_ids) {
+    PointQuery point_query{bounds.getCenter(), glm::length(bounds.getExtent())};
+    OverlapQueryResult overlap_query{bounds.min, bounds.max, max_triangles, out_triangle_vertices, out_triangle_ids};
+
+    rtcPointQuery(scene_.scene_, &point_query, this, overlapQueryFunc, &overlap_query);
+
+    return !overlap_query.b_overflow;
+}
+
+} // namespace embree
\ No newline at end of file
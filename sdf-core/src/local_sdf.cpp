@@ -0,0 +1,1695 @@
+#include "local_sdf.h"
+#include "embree_wrapper.h"
+#include "mesh.h"
+#include "numa_topology.h"
+#include "sdf_math.h"
+#include "sdf_sampler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <execution>
+#include <fmt/core.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <numeric>
+#include <optional>
+
+namespace {
+
+constexpr glm::uint8 MAX_UINT8 = std::numeric_limits<glm::uint8>::max();
+constexpr glm::uint8 MIN_UINT8 = std::numeric_limits<glm::uint8>::min();
+constexpr float MAX_UINT16_FLOAT = std::numeric_limits<glm::uint16>::max(); // baked bricks keep normalized distance at 16 bits
+
+template <std::integral T>
+T divide_and_round_up(T dividend, T divisor) {
+    return (dividend + divisor - 1) / divisor;
+}
+
+template <typename T> // T should be a STL container
+constexpr std::size_t element_size(T const & /*unused*/) {
+    return sizeof(typename T::value_type);
+}
+
+constexpr float max_component(glm::vec3 vec) {
+    return std::max(vec.x, std::max(vec.y, vec.z));
+}
+
+inline glm::uint32 compute_linear_voxel_index(glm::uvec3 voxel_coordinate, glm::uvec3 volume_dimensions) {
+    return (voxel_coordinate.z * volume_dimensions.y + voxel_coordinate.y) * volume_dimensions.x + voxel_coordinate.x;
+}
+
+/// bricks of one mip in the single task graph baking all mips
+template <DistanceField::BrickConfig Config>
+struct MipBakeState {
+    glm::uint32 mip_index;
+    glm::uvec3 indirection_dimensions;
+    Box distance_field_volume_bounds;
+    glm::vec3 indirection_voxel_size;
+    float local_space_trace_distance;
+    float volume_space_max_encoding;
+    std::span<const glm::vec3> sample_directions; // sign rays, none for two-sided meshes
+    glm::uint32 shard_z_begin, shard_z_end; // brick layers baked by this shard, all of them without sharding
+    glm::uint32 refinement_levels;
+    float refinement_error; // local space
+    std::vector<DistanceFieldBrickTask<Config>> brick_tasks;
+    std::atomic<std::size_t> num_pending_bricks;
+
+    // outputs, indirection table followed by brick data
+    glm::uint32 num_bricks;
+    glm::uint32 num_refined_bricks;
+    std::vector<glm::uint8> mip_data;
+};
+
+template <DistanceField::BrickConfig Config>
+bool is_valid_brick(DistanceFieldBrickTask<Config> const &brick) {
+    return brick.brick_max_distance > MIN_UINT8 && brick.brick_min_distance < MAX_UINT8;
+}
+
+/// requantizes the 16 bit voxels of a brick into `out_brick`, returns the (scale, bias) decoding them back to normalized distance
+template <DistanceField::BrickConfig Config>
+glm::vec2 encode_brick(std::span<const glm::uint16> voxels, DistanceField::Encoding encoding, glm::uint8 *out_brick) {
+    constexpr glm::uint32 brick_voxel_count = Config.getBrickVoxelCount();
+    assert(voxels.size() == brick_voxel_count);
+
+    if (encoding == DistanceField::Encoding::uniform_8bit) {
+        for (std::size_t i = 0; i < brick_voxel_count; ++i) out_brick[i] = glm::uint8((voxels[i] * 255u + 32767u) / 65535u);
+        return {1.0f, 0.0f};
+    }
+
+    const auto [min_voxel, max_voxel] = std::minmax_element(voxels.begin(), voxels.end());
+    const float brick_bias = float(*min_voxel) / MAX_UINT16_FLOAT;
+    const float brick_scale = float(*max_voxel - *min_voxel) / MAX_UINT16_FLOAT;
+
+    const glm::uint32 bits_per_voxel = DistanceField::get_bits_per_voxel(encoding);
+    const glm::uint32 max_code = (1u << bits_per_voxel) - 1;
+    const float normalized_to_code = brick_scale > 0.0f ? float(max_code) / brick_scale : 0.0f;
+
+    std::memset(out_brick, 0, DistanceField::get_brick_size_bytes(encoding, Config));
+    for (std::size_t i = 0; i < brick_voxel_count; ++i) {
+        const float normalized_distance = float(voxels[i]) / MAX_UINT16_FLOAT;
+        const glm::uint32 code = glm::min((glm::uint32) glm::round((normalized_distance - brick_bias) * normalized_to_code), max_code);
+
+        if (bits_per_voxel == 4) {
+            out_brick[i / 2] |= glm::uint8(code << (i % 2 * 4));
+        } else if (bits_per_voxel == 8) {
+            out_brick[i] = glm::uint8(code);
+        } else {
+            const auto code16 = glm::uint16(code);
+            std::memcpy(out_brick + i * sizeof(code16), &code16, sizeof(code16));
+        }
+    }
+
+    return {brick_scale, brick_bias};
+}
+
+/// bytes of a mip blob holding `num_bricks`, the per-brick (scale, bias) table comes last
+std::size_t get_mip_data_size(std::size_t indirection_table_bytes, std::size_t num_bricks, DistanceField::Encoding encoding,
+                              DistanceField::BrickConfig brick_config) {
+    const std::size_t brick_scale_bias_bytes = DistanceField::has_brick_scale_bias(encoding) ? sizeof(glm::vec2) : 0;
+    return indirection_table_bytes + num_bricks * (DistanceField::get_brick_size_bytes(encoding, brick_config) + brick_scale_bias_bytes);
+}
+
+/// size of the mip and error against the 16 bit bake for every encoding, errors in voxels (diagonals) of the mip
+template <DistanceField::BrickConfig Config>
+void print_encoding_report(glm::uint32 mip_index, std::size_t indirection_table_bytes,
+                           std::span<DistanceFieldBrickTask<Config> const *const> valid_bricks) {
+    constexpr glm::uint32 brick_voxel_count = Config.getBrickVoxelCount();
+    constexpr std::array encodings{DistanceField::Encoding::uniform_8bit, DistanceField::Encoding::brick_4bit,
+                                   DistanceField::Encoding::brick_8bit, DistanceField::Encoding::brick_16bit};
+    constexpr std::array encoding_names{"uniform 8 bit", "brick 4 bit", "brick 8 bit", "brick 16 bit"};
+    constexpr float normalized_to_voxels = 2.0f * Config.band_size_in_voxels;
+    constexpr std::size_t max_brick_size_bytes = DistanceField::get_brick_size_bytes(DistanceField::Encoding::brick_16bit, Config);
+
+    for (std::size_t encoding_index = 0; encoding_index < encodings.size(); ++encoding_index) {
+        const DistanceField::Encoding encoding = encodings[encoding_index];
+
+        // per brick max and sum of squares, reduced after the parallel pass
+        std::vector<std::pair<float, double>> brick_errors(valid_bricks.size());
+        std::transform(std::execution::par, valid_bricks.begin(), valid_bricks.end(), brick_errors.begin(),
+                       [encoding](DistanceFieldBrickTask<Config> const *brick) {
+                           std::array<glm::uint8, max_brick_size_bytes> encoded;
+                           const glm::vec2 scale_bias = encode_brick<Config>(brick->distance_field_volume, encoding, encoded.data());
+
+                           std::pair<float, double> error{0.0f, 0.0};
+                           for (glm::uint32 i = 0; i < brick_voxel_count; ++i) {
+                               const float reference = float(brick->distance_field_volume[i]) / MAX_UINT16_FLOAT;
+                               const float voxel_error =
+                                   std::abs(DistanceField::decode_voxel(encoded.data(), i, encoding, scale_bias) - reference);
+                               error.first = std::max(error.first, voxel_error);
+                               error.second += double(voxel_error) * voxel_error;
+                           }
+                           return error;
+                       });
+
+        float max_error = 0.0f;
+        double sum_squared_error = 0.0;
+        for (auto const &[brick_max_error, brick_sum_squared_error] : brick_errors) {
+            max_error = std::max(max_error, brick_max_error);
+            sum_squared_error += brick_sum_squared_error;
+        }
+        const double num_voxels = std::max(double(valid_bricks.size()) * brick_voxel_count, 1.0);
+
+        fmt::print("Mip level {} {:>13}: {:>10} bytes, max error {:.4f} voxels, rms error {:.4f} voxels\n", mip_index,
+                   encoding_names[encoding_index], get_mip_data_size(indirection_table_bytes, valid_bricks.size(), encoding, Config),
+                   max_error * normalized_to_voxels, std::sqrt(sum_squared_error / num_voxels) * normalized_to_voxels);
+    }
+}
+
+/// compacts valid bricks of a finished mip, in linear or Morton order of their coordinate, requantized to the bake encoding.
+/// Children of split bricks follow their parent, their entries go in blocks of 8 after the indirection dimensions
+template <DistanceField::BrickConfig Config>
+void pack_mip(MipBakeState<Config> &mip_state, BakeSettings const &settings) {
+    const glm::uvec3 indirection_dimensions = mip_state.indirection_dimensions;
+    std::vector<DistanceFieldBrickTask<Config>> const &brick_tasks = mip_state.brick_tasks;
+
+    std::vector<glm::uint32> indirection_table;
+    indirection_table.resize(std::size_t(indirection_dimensions.x) * indirection_dimensions.y * indirection_dimensions.z,
+                             DistanceField::INVALID_BRICK_INDEX);
+    const std::size_t num_indirection_entries = indirection_table.size();
+
+    std::vector<DistanceFieldBrickTask<Config> const *> valid_bricks;
+    valid_bricks.reserve(brick_tasks.size());
+
+    for (auto const &brick_task : brick_tasks) {
+        if (is_valid_brick(brick_task)) valid_bricks.push_back(&brick_task);
+    }
+
+    // tasks are in chunk order for chunked bakes, sort either way so the layout never depends on chunking
+    const auto brick_order_key = [&](DistanceFieldBrickTask<Config> const *brick) -> std::uint64_t {
+        return settings.morton_brick_order ? morton_encode(brick->brick_coordinate)
+                                           : compute_linear_voxel_index(brick->brick_coordinate, indirection_dimensions);
+    };
+    std::sort(valid_bricks.begin(), valid_bricks.end(),
+              [&](auto const *lhs, auto const *rhs) { return brick_order_key(lhs) < brick_order_key(rhs); });
+
+    // bricks in data order, a split brick is replaced by its valid children
+    std::vector<DistanceFieldBrickTask<Config> const *> packed_bricks;
+    packed_bricks.reserve(valid_bricks.size());
+
+    const auto pack_brick = [&](auto const &pack_brick, DistanceFieldBrickTask<Config> const &brick) -> glm::uint32 {
+        if (brick.refined_bricks.empty()) {
+            packed_bricks.push_back(&brick);
+            return glm::uint32(packed_bricks.size() - 1);
+        }
+
+        const std::size_t block_offset = indirection_table.size();
+        indirection_table.resize(block_offset + brick.refined_bricks.size(), DistanceField::INVALID_BRICK_INDEX);
+        for (std::size_t child_index = 0; child_index < brick.refined_bricks.size(); ++child_index) {
+            DistanceFieldBrickTask<Config> const &child = brick.refined_bricks[child_index];
+            if (is_valid_brick(child)) indirection_table[block_offset + child_index] = pack_brick(pack_brick, child);
+        }
+        return DistanceField::REFINED_BRICK_FLAG | glm::uint32(block_offset);
+    };
+
+    for (DistanceFieldBrickTask<Config> const *brick : valid_bricks) {
+        const glm::uint32 indirection_index = compute_linear_voxel_index(brick->brick_coordinate, indirection_dimensions);
+        indirection_table[indirection_index] = pack_brick(pack_brick, *brick);
+    }
+
+    const glm::uint32 num_bricks = packed_bricks.size();
+    const glm::uint32 brick_size_bytes = DistanceField::get_brick_size_bytes(settings.encoding, Config);
+    // GPixelFormats[G8].BlockBytes == 1 for uniform_8bit
+
+    const std::size_t indirection_table_bytes = indirection_table.size() * element_size(indirection_table);
+
+    /// XXX: un-inited in UE5, vector<T>::resize will do zero-init
+    std::vector<glm::uint8> &mip_data = mip_state.mip_data;
+    mip_data.resize(get_mip_data_size(indirection_table_bytes, num_bricks, settings.encoding, Config));
+    glm::uint8 *distance_field_brick_data = mip_data.data() + indirection_table_bytes;
+    glm::uint8 *brick_scale_bias_data = distance_field_brick_data + (std::size_t) num_bricks * brick_size_bytes;
+
+    for (std::size_t brick_index = 0; brick_index < packed_bricks.size(); ++brick_index) {
+        const DistanceFieldBrickTask<Config> &brick = *packed_bricks[brick_index];
+        const glm::vec2 brick_scale_bias = encode_brick<Config>(brick.distance_field_volume, settings.encoding,
+                                                                &distance_field_brick_data[brick_index * brick_size_bytes]);
+        if (DistanceField::has_brick_scale_bias(settings.encoding)) {
+            std::memcpy(brick_scale_bias_data + brick_index * sizeof(glm::vec2), &brick_scale_bias, sizeof(glm::vec2));
+        }
+    }
+
+    std::memcpy(mip_data.data(), indirection_table.data(), indirection_table_bytes);
+    mip_state.num_bricks = num_bricks;
+    mip_state.num_refined_bricks = glm::uint32((indirection_table.size() - num_indirection_entries) / 8);
+
+    fmt::print("Mip level {} compression: {}/{}\n", mip_state.mip_index, valid_bricks.size(), brick_tasks.size());
+    if (mip_state.num_refined_bricks > 0) {
+        fmt::print("Mip level {} refinement: {} bricks split, {} bricks stored\n", mip_state.mip_index, mip_state.num_refined_bricks,
+                   num_bricks);
+    }
+    if (settings.encoding_report) print_encoding_report<Config>(mip_state.mip_index, indirection_table_bytes, packed_bricks);
+
+    // every brick of this mip is done, release their volumes while other mips keep baking
+    std::vector<DistanceFieldBrickTask<Config>>{}.swap(mip_state.brick_tasks);
+}
+
+/// chunk grid over `bounds_size` holding about `max_chunk_triangles` each, a single chunk if 0. Cells are close to cubes,
+/// flat axes get one chunk and the others split the rest
+glm::uvec3 compute_chunk_dimensions(std::size_t num_triangles, std::size_t max_chunk_triangles, glm::vec3 bounds_size) {
+    if (max_chunk_triangles == 0 || num_triangles <= max_chunk_triangles) return glm::uvec3(1);
+
+    const double num_chunks = std::ceil(double(num_triangles) / double(max_chunk_triangles));
+
+    // edge of a cubic cell, an axis shorter than it stays whole and the cell is resized over the remaining axes
+    std::array<bool, 3> b_split_axis{true, true, true};
+    double cell_size = 0.0;
+    for (int num_split_axes = 3; num_split_axes > 0;) {
+        double split_volume = 1.0;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (b_split_axis[axis]) split_volume *= bounds_size[axis];
+        }
+        cell_size = std::pow(split_volume / num_chunks, 1.0 / num_split_axes);
+
+        const int num_previous_split_axes = num_split_axes;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (b_split_axis[axis] && bounds_size[axis] <= cell_size) {
+                b_split_axis[axis] = false;
+                --num_split_axes;
+            }
+        }
+        if (num_split_axes == num_previous_split_axes) break;
+    }
+
+    glm::uvec3 chunk_dimensions(1);
+    for (int axis = 0; axis < 3; ++axis) {
+        if (b_split_axis[axis]) chunk_dimensions[axis] = (glm::uint32) std::ceil(bounds_size[axis] / cell_size);
+    }
+    return chunk_dimensions;
+}
+
+/// triangles whose bounds overlap each chunk, a triangle may land in several chunks. Chunks are the cells of a grid of
+/// `chunk_size` from `grid_min` with bounds grown past their cell, a triangle only tests the cells its bounds reach once grown
+/// as much. Triangles are numbered across all instances in order and sorted in each chunk, see extract_instance_triangles
+std::vector<std::vector<glm::uint32>> bin_triangles_into_chunks(std::span<const MeshInstance> instances, glm::vec3 grid_min,
+                                                                glm::vec3 chunk_size, glm::uvec3 chunk_dimensions,
+                                                                std::span<const Box> chunk_bounds) {
+    // furthest any chunk reaches past its cell, chunks without bricks have empty bounds and overlap nothing
+    glm::vec3 max_overhang{0.0f};
+    for (glm::uint32 z_index = 0; z_index < chunk_dimensions.z; ++z_index) {
+        for (glm::uint32 y_index = 0; y_index < chunk_dimensions.y; ++y_index) {
+            for (glm::uint32 x_index = 0; x_index < chunk_dimensions.x; ++x_index) {
+                const glm::uvec3 chunk_coordinate{x_index, y_index, z_index};
+                Box const &bounds = chunk_bounds[compute_linear_voxel_index(chunk_coordinate, chunk_dimensions)];
+                if (bounds.min.x > bounds.max.x) continue;
+
+                const glm::vec3 cell_min = grid_min + glm::vec3(chunk_coordinate) * chunk_size;
+                max_overhang = glm::max(max_overhang, glm::max(cell_min - bounds.min, bounds.max - (cell_min + chunk_size)));
+            }
+        }
+    }
+
+    const auto for_each_chunk = [&](MeshInstance const &instance, glm::uint32 triangle_index, auto &&visit) {
+        Mesh const &mesh = *instance.mesh;
+        const glm::uvec3 triangle = mesh.indices[triangle_index];
+        const glm::vec3 V0 = instance.transform * glm::vec4(mesh.vertices[triangle.x], 1.0f);
+        const glm::vec3 V1 = instance.transform * glm::vec4(mesh.vertices[triangle.y], 1.0f);
+        const glm::vec3 V2 = instance.transform * glm::vec4(mesh.vertices[triangle.z], 1.0f);
+        const glm::vec3 triangle_min = glm::min(V0, glm::min(V1, V2));
+        const glm::vec3 triangle_max = glm::max(V0, glm::max(V1, V2));
+
+        const auto to_chunk = [&](glm::vec3 position) {
+            return glm::uvec3(glm::clamp(glm::ivec3(glm::floor((position - grid_min) / chunk_size)), glm::ivec3(0),
+                                         glm::ivec3(chunk_dimensions) - 1));
+        };
+        const glm::uvec3 first_chunk = to_chunk(triangle_min - max_overhang);
+        const glm::uvec3 last_chunk = to_chunk(triangle_max + max_overhang);
+
+        for (glm::uint32 z_index = first_chunk.z; z_index <= last_chunk.z; ++z_index) {
+            for (glm::uint32 y_index = first_chunk.y; y_index <= last_chunk.y; ++y_index) {
+                for (glm::uint32 x_index = first_chunk.x; x_index <= last_chunk.x; ++x_index) {
+                    const glm::uint32 chunk_index = compute_linear_voxel_index({x_index, y_index, z_index}, chunk_dimensions);
+                    Box const &bounds = chunk_bounds[chunk_index];
+                    if (triangle_min.x <= bounds.max.x && triangle_min.y <= bounds.max.y && triangle_min.z <= bounds.max.z &&
+                        triangle_max.x >= bounds.min.x && triangle_max.y >= bounds.min.y && triangle_max.z >= bounds.min.z) {
+                        visit(chunk_index);
+                    }
+                }
+            }
+        }
+    };
+
+    std::size_t max_instance_triangles = 0;
+    for (MeshInstance const &instance : instances) max_instance_triangles = std::max(max_instance_triangles, instance.mesh->indices.size());
+    std::vector<glm::uint32> triangle_indices(max_instance_triangles);
+    std::iota(triangle_indices.begin(), triangle_indices.end(), 0);
+
+    // counted then filled in parallel, each pass over the instances in turn
+    const auto for_each_instance_triangle = [&](auto &&visit) {
+        glm::uint32 triangle_offset = 0;
+        for (MeshInstance const &instance : instances) {
+            const std::size_t num_triangles = instance.mesh->indices.size();
+            std::for_each(std::execution::par, triangle_indices.begin(), triangle_indices.begin() + num_triangles,
+                          [&](glm::uint32 triangle_index) {
+                              for_each_chunk(instance, triangle_index,
+                                             [&](glm::uint32 chunk_index) { visit(chunk_index, triangle_offset + triangle_index); });
+                          });
+            triangle_offset += num_triangles;
+        }
+    };
+
+    std::vector<std::atomic<glm::uint32>> chunk_counts(chunk_bounds.size());
+    for_each_instance_triangle(
+        [&](glm::uint32 chunk_index, glm::uint32) { chunk_counts[chunk_index].fetch_add(1, std::memory_order_relaxed); });
+
+    std::vector<std::vector<glm::uint32>> chunk_triangles(chunk_bounds.size());
+    for (std::size_t chunk_index = 0; chunk_index < chunk_bounds.size(); ++chunk_index) {
+        chunk_triangles[chunk_index].resize(chunk_counts[chunk_index].exchange(0));
+    }
+    for_each_instance_triangle([&](glm::uint32 chunk_index, glm::uint32 triangle_index) {
+        chunk_triangles[chunk_index][chunk_counts[chunk_index].fetch_add(1, std::memory_order_relaxed)] = triangle_index;
+    });
+
+    std::for_each(std::execution::par, chunk_triangles.begin(), chunk_triangles.end(),
+                  [](std::vector<glm::uint32> &triangles) { std::sort(triangles.begin(), triangles.end()); });
+    return chunk_triangles;
+}
+
+/// the given triangles of all instances (sorted, numbered as in bin_triangles_into_chunks) flattened into one mesh in bake space
+Mesh extract_instance_triangles(std::span<const MeshInstance> instances, std::span<const glm::uint32> triangle_indices) {
+    Mesh result;
+    std::vector<glm::uint32> instance_triangle_indices;
+
+    std::size_t next_index = 0;
+    glm::uint32 triangle_offset = 0;
+    for (MeshInstance const &instance : instances) {
+        const glm::uint32 num_triangles = instance.mesh->indices.size();
+
+        instance_triangle_indices.clear();
+        while (next_index < triangle_indices.size() && triangle_indices[next_index] < triangle_offset + num_triangles) {
+            instance_triangle_indices.push_back(triangle_indices[next_index++] - triangle_offset);
+        }
+        triangle_offset += num_triangles;
+        if (instance_triangle_indices.empty()) continue;
+
+        const Mesh part = instance.mesh->extractTriangles(instance_triangle_indices);
+        const bool b_mirrored = glm::determinant(glm::mat3{instance.transform}) < 0.0f; // keep triangles facing out
+        const glm::uint32 vertex_offset = result.vertices.size();
+
+        for (glm::vec3 vertex : part.vertices) result.vertices.push_back(instance.transform * glm::vec4(vertex, 1.0f));
+        for (glm::uvec3 triangle : part.indices) {
+            if (b_mirrored) std::swap(triangle.y, triangle.z);
+            result.indices.push_back(triangle + vertex_offset);
+        }
+    }
+
+    return result;
+}
+
+/// largest factor `transform` stretches lengths by, exact for rotations and scales, bounded by the Frobenius norm under shear
+float get_max_stretch(glm::mat4x3 const &transform) {
+    const glm::vec3 X = transform[0], Y = transform[1], Z = transform[2];
+    const float x_length = glm::length(X), y_length = glm::length(Y), z_length = glm::length(Z);
+
+    constexpr float orthogonal_epsilon = 1e-4f;
+    if (std::abs(glm::dot(X, Y)) <= orthogonal_epsilon * x_length * y_length &&
+        std::abs(glm::dot(Y, Z)) <= orthogonal_epsilon * y_length * z_length &&
+        std::abs(glm::dot(Z, X)) <= orthogonal_epsilon * z_length * x_length) {
+        return std::max(x_length, std::max(y_length, z_length));
+    }
+    return std::sqrt(x_length * x_length + y_length * y_length + z_length * z_length);
+}
+
+/// BVHs of the instances, shared by every mip except those baked against simplified LODs
+class MipScenes {
+public:
+    /// the instanced meshes must outlive the scenes, they reference their buffers. With `b_pseudo_normals`, closed meshes get
+    /// pseudo-normals to sign voxels without rays. Scenes are built on `device`
+    MipScenes(std::span<const MeshInstance> instances, std::span<const float, DistanceField::NUM_MIPS> lod_errors, bool b_pseudo_normals,
+              RTCDevice device = embree::get_shared_device())
+        : instances_{instances.begin(), instances.end()}, device_{device}, b_pseudo_normals_{b_pseudo_normals} {
+        std::ranges::copy(lod_errors, lod_errors_.begin());
+
+        for (MeshInstance const &instance : instances_) {
+            const auto mesh_iterator = std::ranges::find(meshes_, instance.mesh);
+            instance_meshes_.push_back(glm::uint32(mesh_iterator - meshes_.begin()));
+            if (mesh_iterator == meshes_.end()) meshes_.push_back(instance.mesh);
+        }
+    }
+
+    /// builds the scenes `mips` are missing, the LODs of all coarse mips come from one simplification per mesh
+    void prepare(std::span<const glm::uint32> mips) {
+        for (glm::uint32 mip_index : mips) {
+            const glm::uint32 slot = getSlot(mip_index);
+            if (scenes_[slot]) continue;
+
+            if (slot != 0 && !b_simplified_) simplify();
+
+            if (b_pseudo_normals_) computePseudoNormals(slot);
+
+            scenes_[slot].emplace(device_);
+            addInstances(*scenes_[slot], slot);
+            scenes_[slot]->commit();
+        }
+    }
+
+    [[nodiscard]] embree::Scene const &getScene(glm::uint32 mip_index) const { return *scenes_[getSlot(mip_index)]; }
+
+private:
+    [[nodiscard]] glm::uint32 getSlot(glm::uint32 mip_index) const { return lod_errors_[mip_index] > 0.0f ? mip_index : 0; }
+
+    /// a mesh placed once and untransformed goes straight into the scene, others become a prototype shared by their instances
+    void addInstances(embree::Scene &scene, glm::uint32 slot) const {
+        for (glm::uint32 mesh_index = 0; mesh_index < meshes_.size(); ++mesh_index) {
+            Mesh const &mesh = getMesh(slot, mesh_index);
+            MeshPseudoNormals const *pseudo_normals = nullptr;
+            if (!pseudo_normals_[slot].empty() && pseudo_normals_[slot][mesh_index]) pseudo_normals = &*pseudo_normals_[slot][mesh_index];
+
+            std::vector<glm::mat4x3> transforms;
+            for (std::size_t i = 0; i < instances_.size(); ++i) {
+                if (instance_meshes_[i] == mesh_index) transforms.push_back(instances_[i].transform);
+            }
+
+            if (transforms.size() == 1 && transforms.front() == glm::mat4x3{1.0f}) {
+                scene.addMesh(mesh, pseudo_normals);
+            } else {
+                const glm::uint32 prototype_index = scene.addPrototype(mesh, pseudo_normals);
+                for (glm::mat4x3 const &transform : transforms) scene.addInstance(prototype_index, transform);
+            }
+        }
+    }
+
+    [[nodiscard]] Mesh const &getMesh(glm::uint32 slot, glm::uint32 mesh_index) const {
+        return slot == 0 ? *meshes_[mesh_index] : lod_meshes_[slot][mesh_index];
+    }
+
+    /// open or non-manifold meshes are left without, their voxels fall back to sign rays
+    void computePseudoNormals(glm::uint32 slot) {
+        auto pseudo_normals_start_time = std::chrono::steady_clock::now();
+
+        std::size_t num_closed_meshes = 0;
+        for (glm::uint32 mesh_index = 0; mesh_index < meshes_.size(); ++mesh_index) {
+            pseudo_normals_[slot].push_back(getMesh(slot, mesh_index).computePseudoNormals());
+            if (pseudo_normals_[slot].back()) ++num_closed_meshes;
+        }
+
+        auto pseudo_normals_end_time = std::chrono::steady_clock::now();
+        fmt::print("Compute pseudo-normals in {:.1f}s: {} of {} meshes closed, rays sign the rest\n",
+                   std::chrono::duration<double>(pseudo_normals_end_time - pseudo_normals_start_time).count(), num_closed_meshes,
+                   meshes_.size());
+    }
+
+    void simplify() {
+        auto simplify_start_time = std::chrono::steady_clock::now();
+
+        std::vector<glm::uint32> lod_mips;
+        for (glm::uint32 mip_index = 0; mip_index < DistanceField::NUM_MIPS; ++mip_index) {
+            if (getSlot(mip_index) != 0) lod_mips.push_back(mip_index);
+        }
+        for (glm::uint32 mip_index : lod_mips) lod_meshes_[mip_index].resize(meshes_.size());
+
+        std::size_t num_full_triangles = 0;
+        for (glm::uint32 mesh_index = 0; mesh_index < meshes_.size(); ++mesh_index) {
+            // errors are in bake space, the most stretched instance decides how far the mesh itself may move
+            float max_stretch = 0.0f;
+            for (std::size_t i = 0; i < instances_.size(); ++i) {
+                if (instance_meshes_[i] == mesh_index) max_stretch = std::max(max_stretch, get_max_stretch(instances_[i].transform));
+            }
+
+            std::vector<float> max_errors; // coarser mips have larger voxels, so the bounds never decrease
+            for (glm::uint32 mip_index : lod_mips) max_errors.push_back(lod_errors_[mip_index] / std::max(max_stretch, 1e-6f));
+
+            std::vector<Mesh> lods = meshes_[mesh_index]->simplify(max_errors);
+            for (std::size_t i = 0; i < lod_mips.size(); ++i) lod_meshes_[lod_mips[i]][mesh_index] = std::move(lods[i]);
+            num_full_triangles += meshes_[mesh_index]->indices.size();
+        }
+        b_simplified_ = true;
+
+        auto simplify_end_time = std::chrono::steady_clock::now();
+        fmt::print("Simplify mesh in {:.1f}s:", std::chrono::duration<double>(simplify_end_time - simplify_start_time).count());
+        for (glm::uint32 mip_index : lod_mips) {
+            std::size_t num_triangles = 0;
+            for (Mesh const &lod : lod_meshes_[mip_index]) num_triangles += lod.indices.size();
+            fmt::print(" mip {} {} triangles,", mip_index, num_triangles);
+        }
+        fmt::print(" full mesh {} triangles\n", num_full_triangles);
+    }
+
+    std::vector<MeshInstance> instances_;
+    RTCDevice device_;
+    std::vector<Mesh const *> meshes_;         // distinct meshes of the instances
+    std::vector<glm::uint32> instance_meshes_; // index in meshes_ of each instance
+    std::array<float, DistanceField::NUM_MIPS> lod_errors_{};
+    std::array<std::vector<Mesh>, DistanceField::NUM_MIPS> lod_meshes_;         // by mip, then as meshes_
+    std::array<std::vector<std::optional<MeshPseudoNormals>>, DistanceField::NUM_MIPS> pseudo_normals_; // as lod_meshes_
+    std::array<std::optional<embree::Scene>, DistanceField::NUM_MIPS> scenes_; // by mip, mips on the full meshes share the first
+    bool b_pseudo_normals_;
+    bool b_simplified_ = false;
+};
+
+/// copy of the instanced meshes and their scenes for one NUMA node, prepared from a thread pinned to it so their pages are local.
+/// Its scenes commit on that thread alone, the shared device's build threads are not pinned and would scatter the BVH pages
+struct NodeReplica {
+    std::vector<Mesh> meshes;
+    std::optional<MipScenes> scenes;
+    RTCDevice device = nullptr;
+
+    NodeReplica() = default;
+    NodeReplica(NodeReplica const &) = delete;
+    NodeReplica &operator=(NodeReplica const &) = delete;
+    ~NodeReplica() {
+        scenes.reset();
+        if (device) rtcReleaseDevice(device);
+    }
+
+    void prepare(std::span<const MeshInstance> instances, std::span<const float, DistanceField::NUM_MIPS> lod_errors,
+                 bool b_pseudo_normals, std::span<const glm::uint32> mips) {
+        if (!scenes) {
+            std::vector<Mesh const *> source_meshes;
+            for (MeshInstance const &instance : instances) {
+                if (std::ranges::find(source_meshes, instance.mesh) == source_meshes.end()) source_meshes.push_back(instance.mesh);
+            }
+            meshes.reserve(source_meshes.size());
+            for (Mesh const *mesh : source_meshes) meshes.push_back(*mesh);
+
+            std::vector<MeshInstance> replica_instances;
+            for (MeshInstance const &instance : instances) {
+                const std::size_t mesh_index = std::ranges::find(source_meshes, instance.mesh) - source_meshes.begin();
+                replica_instances.push_back({&meshes[mesh_index], instance.transform});
+            }
+            device = embree::new_calling_thread_device();
+            scenes.emplace(replica_instances, lod_errors, b_pseudo_normals, device);
+        }
+        scenes->prepare(mips);
+    }
+};
+
+/// past this many triangles near a brick, per-voxel BVH traversal beats the brute-force kernel
+constexpr std::size_t MAX_BINNED_TRIANGLES_PER_BRICK = 128;
+
+} // namespace
+
+template <DistanceField::BrickConfig Config>
+DistanceFieldBrickTask<Config>::DistanceFieldBrickTask(embree::Scene const &embree_scene, std::span<const glm::vec3> sample_direction,
+                                                       float local_space_trace_distance, Box volume_bounds, glm::uvec3 brick_coordinate,
+                                                       glm::vec3 indirection_voxel_size, bool b_generate_as_if_two_sided,
+                                                       bool b_triangle_binning, glm::uint32 refinement_levels, float refinement_error,
+                                                       SignMode sign_mode)
+    : embree_scene{embree_scene}, sample_direction{sample_direction}, local_space_trace_distance{local_space_trace_distance},
+      volume_bounds{volume_bounds}, brick_coordinate{brick_coordinate}, indirection_voxel_size{indirection_voxel_size},
+      b_generate_as_if_two_sided{b_generate_as_if_two_sided}, b_triangle_binning{b_triangle_binning},
+      refinement_levels{refinement_levels}, refinement_error{refinement_error}, sign_mode{sign_mode}, brick_max_distance{MIN_UINT8},
+      brick_min_distance{MAX_UINT8} {}
+
+template <DistanceField::BrickConfig Config>
+void DistanceFieldBrickTask<Config>::doWork() {
+    const glm::vec3 distance_field_voxel_size = indirection_voxel_size / (float) Config.getUniqueDataBrickSize();
+    const glm::vec3 brick_min_position = volume_bounds.min + glm::vec3(brick_coordinate) * indirection_voxel_size;
+    const float two_sided_surface_offset = glm::length(distance_field_voxel_size) * DistanceField::TWO_SIDED_SURFACE_OFFSET_IN_VOXELS;
+
+    const float point_query_radius = 1.5f * local_space_trace_distance;
+
+    embree::ClosestQueryContext point_query{embree_scene};
+    embree::IntersectionContext intersect{embree_scene};
+
+    constexpr std::size_t brick_voxel_count = BRICK_VOXEL_COUNT;
+    distance_field_volume.resize(brick_voxel_count);
+
+    // bin triangles near the brick once, then evaluate all voxels against them instead of traversing the BVH per voxel
+    std::vector<glm::vec3> binned_triangle_vertices;
+    std::vector<glm::uvec2> binned_triangle_ids; // (geom_id, prim_id), only to sign with pseudo-normals
+    std::vector<float> binned_distance_sq;
+    std::vector<std::uint32_t> binned_closest_triangle;
+    bool b_use_binned_triangles = false;
+
+    const bool b_pseudo_normal_sign = sign_mode == SignMode::pseudo_normal && !b_generate_as_if_two_sided;
+
+    if (b_triangle_binning) {
+        const Box brick_bounds{brick_min_position, brick_min_position + indirection_voxel_size};
+        embree::OverlapQueryContext overlap_query{embree_scene};
+        b_use_binned_triangles =
+            overlap_query.query(brick_bounds.expandBy(glm::vec3(local_space_trace_distance)), MAX_BINNED_TRIANGLES_PER_BRICK,
+                                binned_triangle_vertices, b_pseudo_normal_sign ? &binned_triangle_ids : nullptr);
+    }
+
+    if (b_use_binned_triangles) {
+        std::array<float, brick_voxel_count> xs, ys, zs;
+        for (glm::uint32 index = 0; index < brick_voxel_count; ++index) {
+            const glm::uvec3 voxel_coordinate{
+                index % BRICK_SIZE,
+                index / BRICK_SIZE % BRICK_SIZE,
+                index / BRICK_SIZE / BRICK_SIZE,
+            };
+            const glm::vec3 sample_position = glm::vec3(voxel_coordinate) * distance_field_voxel_size + brick_min_position;
+            xs[index] = sample_position.x;
+            ys[index] = sample_position.y;
+            zs[index] = sample_position.z;
+        }
+
+        // same initial radius as the point query, triangles beyond the trace distance only matter up to clamping
+        binned_distance_sq.resize(brick_voxel_count, point_query_radius * point_query_radius);
+        if (b_pseudo_normal_sign) {
+            binned_closest_triangle.resize(brick_voxel_count, std::numeric_limits<std::uint32_t>::max());
+            TriangleSoupDistance{binned_triangle_vertices}.minDistanceSquared(xs, ys, zs, binned_distance_sq, binned_closest_triangle);
+        } else {
+            TriangleSoupDistance{binned_triangle_vertices}.minDistanceSquared(xs, ys, zs, binned_distance_sq);
+        }
+    }
+
+    for (glm::uint32 z_index = 0; z_index < BRICK_SIZE; ++z_index) {
+        for (glm::uint32 y_index = 0; y_index < BRICK_SIZE; ++y_index) {
+            for (glm::uint32 x_index = 0; x_index < BRICK_SIZE; ++x_index) {
+                const glm::vec3 sample_position = glm::vec3(x_index, y_index, z_index) * distance_field_voxel_size + brick_min_position;
+                const glm::uint32 index = z_index * BRICK_SIZE * BRICK_SIZE + y_index * BRICK_SIZE + x_index;
+
+                float closest_distance;
+                glm::uvec2 closest_triangle_id{RTC_INVALID_GEOMETRY_ID};
+                if (b_use_binned_triangles) {
+                    closest_distance = std::sqrt(binned_distance_sq[index]);
+                    if (b_pseudo_normal_sign && binned_closest_triangle[index] < binned_triangle_ids.size()) {
+                        closest_triangle_id = binned_triangle_ids[binned_closest_triangle[index]];
+                    }
+                } else {
+                    const embree::ClosestQueryResult closest = point_query.query(sample_position, point_query_radius);
+                    closest_distance = closest.getDistance();
+                    closest_triangle_id = {closest.geom_id, closest.prim_id};
+                }
+
+                if (b_generate_as_if_two_sided) {
+                    // no inside for two-sided surfaces, bias unsigned distance to keep a thin negative shell
+                    closest_distance -= two_sided_surface_offset;
+                } else {
+                    // pseudo-normals sign every voxel with a closest triangle, rays only those within the trace distance
+                    std::optional<bool> b_inside;
+                    if (b_pseudo_normal_sign && closest_triangle_id.x != RTC_INVALID_GEOMETRY_ID) {
+                        b_inside = embree_scene.isInsideAt(sample_position, closest_triangle_id.x, closest_triangle_id.y);
+                    }
+                    if (!b_inside && closest_distance <= local_space_trace_distance) {
+                        b_inside = intersect.isInside(sample_position, sample_direction, local_space_trace_distance);
+                    }
+                    if (b_inside.value_or(false)) closest_distance *= -1;
+                }
+
+                // pseudo-normals sign voxels up to the query radius, past the trace distance on the inside too
+                const float rescaled_distance =
+                    glm::clamp((closest_distance + local_space_trace_distance) / (2 * local_space_trace_distance), 0.0f, 1.0f);
+                const auto quantized_distance = glm::uint8(glm::round(rescaled_distance * 255.0f));
+
+                distance_field_volume[index] = glm::uint16(glm::round(rescaled_distance * MAX_UINT16_FLOAT));
+                brick_min_distance = glm::min(brick_min_distance, quantized_distance);
+                brick_max_distance = glm::max(brick_max_distance, quantized_distance);
+            }
+        }
+    }
+
+    // bricks that are not stored drop their voxels now, so a bake holds the voxels of the stored bricks and of those in flight
+    if (!is_valid_brick(*this)) {
+        std::vector<glm::uint16>{}.swap(distance_field_volume);
+        return;
+    }
+    if (refinement_levels == 0) return;
+
+    // trilinear reconstruction against exact distance at the centers of cells near the surface, the only place errors show
+    const auto voxel_distance = [this](glm::uvec3 voxel) {
+        const glm::uint16 normalized_distance = distance_field_volume[(voxel.z * BRICK_SIZE + voxel.y) * BRICK_SIZE + voxel.x];
+        return (2.0f * float(normalized_distance) / MAX_UINT16_FLOAT - 1.0f) * local_space_trace_distance;
+    };
+    const float near_surface_distance = glm::length(distance_field_voxel_size);
+
+    std::vector<float> center_xs, center_ys, center_zs, reconstructed_distances;
+    for (glm::uint32 z_index = 0; z_index + 1 < BRICK_SIZE; ++z_index) {
+        for (glm::uint32 y_index = 0; y_index + 1 < BRICK_SIZE; ++y_index) {
+            for (glm::uint32 x_index = 0; x_index + 1 < BRICK_SIZE; ++x_index) {
+                const glm::uvec3 cell{x_index, y_index, z_index};
+
+                float interpolated_distance = 0.0f, min_corner_distance = std::numeric_limits<float>::max();
+                for (glm::uint32 corner = 0; corner < 8; ++corner) {
+                    const float corner_distance = voxel_distance(cell + glm::uvec3{corner & 1, corner >> 1 & 1, corner >> 2 & 1});
+                    interpolated_distance += 0.125f * corner_distance;
+                    min_corner_distance = std::min(min_corner_distance, std::abs(corner_distance));
+                }
+                if (min_corner_distance > near_surface_distance) continue;
+
+                const glm::vec3 center_position = (glm::vec3(cell) + 0.5f) * distance_field_voxel_size + brick_min_position;
+                center_xs.push_back(center_position.x);
+                center_ys.push_back(center_position.y);
+                center_zs.push_back(center_position.z);
+                // compared unsigned, the sign would need rays and is wrong only where the distance is small anyway
+                reconstructed_distances.push_back(b_generate_as_if_two_sided ? interpolated_distance + two_sided_surface_offset
+                                                                             : std::abs(interpolated_distance));
+            }
+        }
+    }
+
+    std::vector<float> exact_distance_sq(center_xs.size(), point_query_radius * point_query_radius);
+    if (b_use_binned_triangles) {
+        TriangleSoupDistance{binned_triangle_vertices}.minDistanceSquared(center_xs, center_ys, center_zs, exact_distance_sq);
+    } else {
+        for (std::size_t i = 0; i < center_xs.size(); ++i) {
+            const float exact_distance = point_query.queryDistance({center_xs[i], center_ys[i], center_zs[i]}, point_query_radius);
+            exact_distance_sq[i] = exact_distance * exact_distance;
+        }
+    }
+
+    for (std::size_t i = 0; i < exact_distance_sq.size(); ++i) {
+        const float exact_distance = std::min(std::sqrt(exact_distance_sq[i]), local_space_trace_distance);
+        max_reconstruction_error = std::max(max_reconstruction_error, std::abs(exact_distance - reconstructed_distances[i]));
+    }
+
+    if (max_reconstruction_error <= refinement_error) return;
+
+    // children cover the brick with twice its resolution, in the same normalized distance range
+    const Box brick_bounds{brick_min_position, brick_min_position + indirection_voxel_size};
+    refined_bricks.reserve(8);
+    for (glm::uint32 child_index = 0; child_index < 8; ++child_index) {
+        const glm::uvec3 child_coordinate{child_index & 1, child_index >> 1 & 1, child_index >> 2 & 1};
+        DistanceFieldBrickTask &child = refined_bricks.emplace_back(
+            embree_scene, sample_direction, local_space_trace_distance, brick_bounds, child_coordinate, 0.5f * indirection_voxel_size,
+            b_generate_as_if_two_sided, b_triangle_binning, refinement_levels - 1, refinement_error, sign_mode);
+        child.doWork();
+    }
+
+    // nothing left of the surface once resolved, keep the brick as is
+    if (std::ranges::none_of(refined_bricks, [](auto const &child) { return is_valid_brick(child); })) {
+        std::vector<DistanceFieldBrickTask>{}.swap(refined_bricks);
+    } else {
+        std::vector<glm::uint16>{}.swap(distance_field_volume); // the children are stored instead
+    }
+}
+
+namespace {
+
+/// generate_distance_field_volume_data for one brick config, sizes below are in its bricks
+template <DistanceField::BrickConfig Config>
+void bake_distance_field(std::span<const MeshInstance> instances, Box local_space_mesh_bounds, float distance_field_resolution_scale,
+                         bool b_generate_as_if_two_sided, BakeSettings const &settings, DistanceFieldVolumeData &out_data,
+                         DistanceFieldBakeControl *control) {
+    constexpr glm::uint32 unique_data_brick_size = Config.getUniqueDataBrickSize();
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    { // ensure minimal 1x1x1 bounds to handle planes
+        const glm::vec3 mesh_bound_center = local_space_mesh_bounds.getCenter();
+        const glm::vec3 mesh_bound_extent = glm::max(local_space_mesh_bounds.getExtent(), glm::vec3(1.0f, 1.0f, 1.0f));
+        local_space_mesh_bounds.min = mesh_bound_center - mesh_bound_extent;
+        local_space_mesh_bounds.max = mesh_bound_center + mesh_bound_extent;
+    }
+
+    const float num_voxel_per_local = settings.voxel_density * distance_field_resolution_scale;
+
+    if (b_generate_as_if_two_sided) {
+        // vertices of two-sided meshes may lie right on the bounds, leaving zero gradient on the border for central differencing
+        const glm::vec3 desired_dimensions =
+            local_space_mesh_bounds.getSize() * (num_voxel_per_local / unique_data_brick_size);
+        const glm::uvec3 mip0_indirection_dimensions =
+            glm::clamp((glm::uvec3) glm::round(desired_dimensions), 1u, DistanceField::MAX_INDIRECTION_DIMENSION);
+
+        const glm::vec3 texel_size = local_space_mesh_bounds.getSize() /
+                                     (glm::vec3(mip0_indirection_dimensions * unique_data_brick_size) -
+                                      glm::vec3(2 * DistanceField::CENTRAL_DIFFERENCING_EXPAND_IN_VOXELS));
+        local_space_mesh_bounds = local_space_mesh_bounds.expandBy(texel_size);
+    }
+
+    const float local_to_volume_scale = 1.0f / max_component(local_space_mesh_bounds.getExtent());
+
+    const glm::vec3 desired_dimensions = local_space_mesh_bounds.getSize() * (num_voxel_per_local / unique_data_brick_size);
+
+    const glm::uvec3 mip0_indirection_dimensions =
+        glm::clamp((glm::uvec3) glm::round(desired_dimensions), 1u, DistanceField::MAX_INDIRECTION_DIMENSION);
+
+    std::array<MipBakeState<Config>, DistanceField::NUM_MIPS> mip_states;
+    std::array<float, DistanceField::NUM_MIPS> lod_errors{}; // local space, 0 for mips baked against the full mesh
+
+    for (glm::uint32 mip_index = 0; mip_index < DistanceField::NUM_MIPS; ++mip_index) {
+        MipBakeState<Config> &mip_state = mip_states[mip_index];
+
+        const glm::uvec3 indirection_dimensions{
+            divide_and_round_up(mip0_indirection_dimensions.x, 1u << mip_index),
+            divide_and_round_up(mip0_indirection_dimensions.y, 1u << mip_index),
+            divide_and_round_up(mip0_indirection_dimensions.z, 1u << mip_index),
+        };
+
+        const glm::vec3 texel_size =
+            local_space_mesh_bounds.getSize() / glm::vec3(indirection_dimensions * unique_data_brick_size -
+                                                          2 * DistanceField::MESH_DISTANCE_FIELD_OBJECT_BORDER);
+        const Box distance_field_volume_bounds = local_space_mesh_bounds.expandBy(texel_size);
+        const glm::vec3 indirection_voxel_size = distance_field_volume_bounds.getSize() / glm::vec3(indirection_dimensions);
+
+        const float distance_field_voxel_size = glm::length(indirection_voxel_size) / unique_data_brick_size;
+        const float local_space_trace_distance = distance_field_voxel_size * Config.band_size_in_voxels;
+
+        mip_state.mip_index = mip_index;
+        mip_state.indirection_dimensions = indirection_dimensions;
+        mip_state.distance_field_volume_bounds = distance_field_volume_bounds;
+        mip_state.indirection_voxel_size = indirection_voxel_size;
+        mip_state.local_space_trace_distance = local_space_trace_distance;
+        mip_state.volume_space_max_encoding = local_space_trace_distance * local_to_volume_scale;
+        mip_state.sample_directions =
+            b_generate_as_if_two_sided ? std::span<const glm::vec3>{} : fibonacci_sphere_directions(settings.num_sign_rays[mip_index]);
+
+        // only mip 0 adapts, coarser mips are the streaming fallback and stay uniform
+        mip_state.refinement_levels = mip_index == 0 ? std::min(settings.refinement_levels, DistanceField::MAX_REFINEMENT_LEVELS) : 0;
+        mip_state.refinement_error = settings.refinement_error * distance_field_voxel_size;
+        if (mip_index > 0) lod_errors[mip_index] = settings.coarse_mip_lod_error * distance_field_voxel_size;
+
+        // shards split every mip along z the same way, so a mip-0 slab lines up with its coarser slabs
+        mip_state.shard_z_begin = indirection_dimensions.z * settings.shard_index / settings.num_shards;
+        mip_state.shard_z_end = indirection_dimensions.z * (settings.shard_index + 1) / settings.num_shards;
+
+        // tasks are appended chunk by chunk, never reallocate under the task graph
+        const std::size_t num_brick_tasks =
+            std::size_t(indirection_dimensions.x) * indirection_dimensions.y * (mip_state.shard_z_end - mip_state.shard_z_begin);
+        mip_state.brick_tasks.reserve(num_brick_tasks);
+        mip_state.num_pending_bricks = num_brick_tasks;
+    }
+
+    // chunked: split the volume in chunks, only one chunk of the mesh lives in a BVH at a time. The meshes themselves stay loaded
+    std::size_t num_triangles = 0;
+    for (MeshInstance const &instance : instances) num_triangles += instance.mesh->indices.size();
+
+    const glm::uvec3 chunk_dimensions =
+        compute_chunk_dimensions(num_triangles, settings.max_chunk_triangles, local_space_mesh_bounds.getSize());
+    const glm::uint32 num_chunks = chunk_dimensions.x * chunk_dimensions.y * chunk_dimensions.z;
+    const glm::vec3 chunk_size = local_space_mesh_bounds.getSize() / glm::vec3(chunk_dimensions);
+
+    // bricks are owned by the chunk holding their center, chunk bounds grow to their bricks plus the trace band
+    std::vector<std::vector<std::pair<glm::uint32, glm::uvec3>>> chunk_bricks(num_chunks);
+    std::vector<Box> chunk_bounds(num_chunks,
+                                  Box{glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max())});
+
+    for (MipBakeState<Config> const &mip_state : mip_states) {
+        const glm::uvec3 indirection_dimensions = mip_state.indirection_dimensions;
+
+        for (glm::uint32 z_index = mip_state.shard_z_begin; z_index < mip_state.shard_z_end; ++z_index) {
+            for (glm::uint32 y_index = 0; y_index < indirection_dimensions.y; ++y_index) {
+                for (glm::uint32 x_index = 0; x_index < indirection_dimensions.x; ++x_index) {
+                    const glm::uvec3 brick_coordinate{x_index, y_index, z_index};
+                    const Box brick_bounds{
+                        mip_state.distance_field_volume_bounds.min + glm::vec3(brick_coordinate) * mip_state.indirection_voxel_size,
+                        mip_state.distance_field_volume_bounds.min + glm::vec3(brick_coordinate + 1u) * mip_state.indirection_voxel_size,
+                    };
+
+                    const glm::ivec3 chunk_coordinate = glm::clamp(
+                        glm::ivec3(glm::floor((brick_bounds.getCenter() - local_space_mesh_bounds.min) / chunk_size)), glm::ivec3(0),
+                        glm::ivec3(chunk_dimensions) - 1);
+                    const glm::uint32 chunk_index = compute_linear_voxel_index(glm::uvec3(chunk_coordinate), chunk_dimensions);
+
+                    chunk_bricks[chunk_index].emplace_back(mip_state.mip_index, brick_coordinate);
+
+                    const Box traced_bounds = brick_bounds.expandBy(glm::vec3(mip_state.local_space_trace_distance));
+                    chunk_bounds[chunk_index].min = glm::min(chunk_bounds[chunk_index].min, traced_bounds.min);
+                    chunk_bounds[chunk_index].max = glm::max(chunk_bounds[chunk_index].max, traced_bounds.max);
+                }
+            }
+        }
+    }
+
+    std::vector<std::vector<glm::uint32>> chunk_triangles;
+    if (num_chunks > 1) {
+        chunk_triangles = bin_triangles_into_chunks(instances, local_space_mesh_bounds.min, chunk_size, chunk_dimensions, chunk_bounds);
+        fmt::print("Chunked bake in {}x{}x{} chunks\n", chunk_dimensions.x, chunk_dimensions.y, chunk_dimensions.z);
+    }
+
+    if (control) {
+        std::size_t num_total_bricks = 0;
+        for (auto const &bricks : chunk_bricks) num_total_bricks += bricks.size();
+        control->num_total_bricks = num_total_bricks;
+    }
+
+    // the last finished brick of a mip packs it, no mip waits for the others
+    auto bake_brick = [&mip_states, &settings, control](std::pair<glm::uint32, DistanceFieldBrickTask<Config> *> const &node) {
+        // a stopped bake leaves its mip pending, so it is never packed
+        if (control && control->isStopped()) return;
+
+        node.second->doWork();
+        if (control) control->num_baked_bricks.fetch_add(1, std::memory_order_relaxed);
+
+        MipBakeState<Config> &mip_state = mip_states[node.first];
+        if (mip_state.num_pending_bricks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            pack_mip(mip_state, settings);
+        }
+    };
+
+    // mips at or below `finest_mip_index` form the volume, snapshots copy the packed mips and the final result moves them
+    auto assemble_volume_data = [&](glm::uint32 finest_mip_index, bool b_snapshot, DistanceFieldVolumeData &data) {
+        std::vector<glm::uint8> streamable_mip_data;
+
+        for (glm::uint32 mip_index = 0; mip_index < DistanceField::NUM_MIPS; ++mip_index) {
+            MipBakeState<Config> &mip_state = mip_states[mip_index];
+            SparseDistanceFieldMip &out_mip = data.mips[mip_index];
+
+            if (mip_index < finest_mip_index) { // not baked, left empty
+                out_mip = SparseDistanceFieldMip{};
+                continue;
+            }
+
+            const glm::uvec3 indirection_dimensions = mip_state.indirection_dimensions;
+            const float volume_space_max_encoding = mip_state.volume_space_max_encoding;
+
+            if (mip_index == DistanceField::NUM_MIPS - 1) {
+                out_mip.bulk_offset = out_mip.bulk_size = 0;
+                data.always_loaded_mip = b_snapshot ? mip_state.mip_data : std::move(mip_state.mip_data);
+            } else if (streamable_mip_data.empty()) {
+                out_mip.bulk_offset = 0;
+                out_mip.bulk_size = mip_state.mip_data.size();
+                streamable_mip_data = b_snapshot ? mip_state.mip_data : std::move(mip_state.mip_data);
+            } else {
+                out_mip.bulk_offset = streamable_mip_data.size();
+                out_mip.bulk_size = mip_state.mip_data.size();
+                streamable_mip_data.insert(streamable_mip_data.end(), mip_state.mip_data.begin(), mip_state.mip_data.end());
+            }
+
+            out_mip.indirection_dimensions = indirection_dimensions;
+            out_mip.distance_field_to_volume_scale_bias = glm::vec2{2 * volume_space_max_encoding, -volume_space_max_encoding};
+            out_mip.num_distance_field_bricks = mip_state.num_bricks;
+            out_mip.num_refined_bricks = mip_state.num_refined_bricks;
+
+            const glm::vec3 virtual_uv_min = glm::vec3(DistanceField::MESH_DISTANCE_FIELD_OBJECT_BORDER) /
+                                             glm::vec3(indirection_dimensions * unique_data_brick_size);
+            const glm::vec3 virtual_uv_size = glm::vec3(indirection_dimensions * unique_data_brick_size -
+                                                        2 * DistanceField::MESH_DISTANCE_FIELD_OBJECT_BORDER) /
+                                              glm::vec3(indirection_dimensions * unique_data_brick_size);
+
+            const glm::vec3 volume_space_extent = local_space_mesh_bounds.getExtent() * local_to_volume_scale;
+
+            out_mip.volume_to_virtual_uv_scale = virtual_uv_size / (2.0f * volume_space_extent);
+            out_mip.volume_to_virtual_uv_add = volume_space_extent * out_mip.volume_to_virtual_uv_scale + virtual_uv_min;
+        }
+
+        data.local_space_mesh_bounds = local_space_mesh_bounds;
+        data.b_mostly_two_sided = b_generate_as_if_two_sided;
+        data.encoding = settings.encoding;
+        data.brick_config = Config;
+        data.streamable_mips = std::move(streamable_mip_data); // XXX: should use streaming bulk in Chaos
+    };
+
+    // a shard may own no brick layer of a coarse mip, its empty mip is complete from the start
+    for (MipBakeState<Config> &mip_state : mip_states) {
+        if (mip_state.num_pending_bricks == 0) pack_mip(mip_state, settings);
+    }
+
+    // all mips share one task graph, a progressive bake finishes them one by one from the coarsest
+    std::vector<std::vector<glm::uint32>> mip_groups;
+    if (control) {
+        for (glm::uint32 mip_index = DistanceField::NUM_MIPS; mip_index-- > 0;) mip_groups.push_back({mip_index});
+    } else {
+        mip_groups.emplace_back();
+        for (glm::uint32 mip_index = 0; mip_index < DistanceField::NUM_MIPS; ++mip_index) mip_groups.back().push_back(mip_index);
+    }
+
+    std::optional<MipScenes> full_scenes; // kept across mip groups when not chunked
+
+    // the brick grid of every mip is split in z slabs, one per node, baked by threads pinned to it, which also allocate
+    // and so first touch the voxels of their bricks
+    std::optional<NumaTopology> numa_topology;
+    if (settings.numa_placement && settings.parallel) {
+        numa_topology = settings.numa_simulated_nodes > 0 ? NumaTopology::simulate(settings.numa_simulated_nodes) : NumaTopology::detect();
+        fmt::print("NUMA placement on {} nodes{}\n", numa_topology->getNumNodes(), settings.numa_simulated_nodes > 0 ? " (simulated)" : "");
+    }
+    const glm::uint32 num_numa_nodes = numa_topology ? numa_topology->getNumNodes() : 1;
+
+    // read-only meshes and BVHs per node, chunks are short-lived and share theirs
+    std::vector<NodeReplica> node_replicas(numa_topology && settings.numa_replicate_scenes && num_chunks == 1 ? num_numa_nodes : 0);
+
+    // chunk meshes are cut open at the chunk borders, they always vote with rays
+    const bool b_pseudo_normals = settings.sign_mode == SignMode::pseudo_normal && !b_generate_as_if_two_sided;
+
+    for (std::size_t group_index = 0; group_index < mip_groups.size(); ++group_index) {
+        std::vector<glm::uint32> const &group_mips = mip_groups[group_index];
+        const bool b_last_group = group_index + 1 == mip_groups.size();
+
+        if (control && control->isStopped()) break;
+
+        for (glm::uint32 chunk_index = 0; chunk_index < num_chunks; ++chunk_index) {
+            std::vector<std::pair<glm::uint32, glm::uvec3>> group_bricks;
+            auto is_group_mip = [&group_mips](glm::uint32 mip_index) {
+                return std::ranges::find(group_mips, mip_index) != group_mips.end();
+            };
+            std::ranges::copy_if(chunk_bricks[chunk_index], std::back_inserter(group_bricks), is_group_mip,
+                                 &std::pair<glm::uint32, glm::uvec3>::first);
+            if (b_last_group) std::vector<std::pair<glm::uint32, glm::uvec3>>{}.swap(chunk_bricks[chunk_index]);
+            if (group_bricks.empty()) continue;
+
+            auto scene_prepare_start_time = std::chrono::steady_clock::now();
+
+            Mesh chunk_mesh;
+            std::optional<MipScenes> chunk_scenes;
+            MipScenes *scenes = nullptr;
+
+            if (num_chunks > 1) {
+                // chunks flatten their part of the instances, and simplify it on its own with borders staying put so chunks still meet
+                chunk_mesh = extract_instance_triangles(instances, chunk_triangles[chunk_index]);
+                if (b_last_group) std::vector<glm::uint32>{}.swap(chunk_triangles[chunk_index]);
+                const MeshInstance chunk_instance{&chunk_mesh};
+                chunk_scenes.emplace(std::span{&chunk_instance, 1}, lod_errors, false);
+                scenes = &*chunk_scenes;
+            } else if (node_replicas.empty()) {
+                if (!full_scenes) full_scenes.emplace(instances, lod_errors, b_pseudo_normals);
+                scenes = &*full_scenes;
+            }
+
+            if (scenes) {
+                scenes->prepare(group_mips);
+            } else {
+                for (glm::uint32 node = 0; node < num_numa_nodes; ++node) {
+                    run_pinned_on_node(*numa_topology, node,
+                                       [&] { node_replicas[node].prepare(instances, lod_errors, b_pseudo_normals, group_mips); });
+                }
+            }
+
+            auto scene_prepare_end_time = std::chrono::steady_clock::now();
+            fmt::print("Prepare embree scene in {:.1f}s\n",
+                       std::chrono::duration<double>(scene_prepare_end_time - scene_prepare_start_time).count());
+
+            // coarse mips go first, so they finish and get packed while mip 0 is still baking
+            std::ranges::stable_sort(group_bricks, std::ranges::greater{}, &std::pair<glm::uint32, glm::uvec3>::first);
+
+            // one task list per NUMA node, a single one without NUMA placement
+            std::vector<std::vector<std::pair<glm::uint32, DistanceFieldBrickTask<Config> *>>> node_task_graphs(num_numa_nodes);
+
+            for (auto const &[mip_index, brick_coordinate] : group_bricks) {
+                MipBakeState<Config> &mip_state = mip_states[mip_index];
+                const glm::uint32 node = (brick_coordinate.z - mip_state.shard_z_begin) * num_numa_nodes /
+                                         (mip_state.shard_z_end - mip_state.shard_z_begin);
+                MipScenes const &brick_scenes = scenes ? *scenes : *node_replicas[node].scenes;
+
+                DistanceFieldBrickTask<Config> &brick_task = mip_state.brick_tasks.emplace_back(
+                    brick_scenes.getScene(mip_index), mip_state.sample_directions, mip_state.local_space_trace_distance,
+                    mip_state.distance_field_volume_bounds, brick_coordinate, mip_state.indirection_voxel_size, b_generate_as_if_two_sided,
+                    settings.triangle_binning, mip_state.refinement_levels, mip_state.refinement_error, settings.sign_mode);
+                node_task_graphs[node].emplace_back(mip_index, &brick_task);
+            }
+
+            // XXX: use Async task mechanism in Chaos for parallel-for, if available
+            if (numa_topology) {
+                std::vector<std::size_t> num_node_tasks;
+                for (auto const &node_task_graph : node_task_graphs) num_node_tasks.push_back(node_task_graph.size());
+                run_pinned_per_node(*numa_topology, num_node_tasks,
+                                    [&](glm::uint32 node, std::size_t task_index) { bake_brick(node_task_graphs[node][task_index]); });
+            } else if (settings.parallel) {
+                // not par_unseq, completion counters synchronize between tasks
+                std::for_each(std::execution::par, node_task_graphs[0].begin(), node_task_graphs[0].end(), bake_brick);
+            } else {
+                std::for_each(node_task_graphs[0].begin(), node_task_graphs[0].end(), bake_brick);
+            }
+        }
+
+        if (control) {
+            const glm::uint32 group_mip_index = group_mips.front();
+            if (mip_states[group_mip_index].num_pending_bricks != 0) break; // stopped halfway
+
+            control->finest_complete_mip = group_mip_index;
+            if (control->on_mip_complete && !b_last_group) {
+                DistanceFieldVolumeData snapshot;
+                assemble_volume_data(group_mip_index, true, snapshot);
+                control->on_mip_complete(snapshot, group_mip_index);
+            }
+        }
+    }
+
+    const glm::uint32 finest_mip_index = control ? control->finest_complete_mip.load() : 0;
+    if (finest_mip_index == DistanceField::NUM_MIPS) return; // stopped before the first mip
+
+    assemble_volume_data(finest_mip_index, false, out_data);
+    if (control && control->on_mip_complete && finest_mip_index == 0) control->on_mip_complete(out_data, finest_mip_index);
+
+    auto end_time = std::chrono::steady_clock::now();
+    fmt::print("Distance field calculation finished in {:.1f}s overall - {}x{}x{} sparse distance field.\n",
+               std::chrono::duration<double>(end_time - start_time).count(),
+               mip0_indirection_dimensions.x * unique_data_brick_size,
+               mip0_indirection_dimensions.y * unique_data_brick_size,
+               mip0_indirection_dimensions.z * unique_data_brick_size);
+}
+
+} // namespace
+
+void generate_distance_field_volume_data(Mesh const &mesh, Box local_space_mesh_bounds, float distance_field_resolution_scale,
+                                         bool b_generate_as_if_two_sided, BakeSettings const &settings, DistanceFieldVolumeData &out_data,
+                                         DistanceFieldBakeControl *control) {
+    const MeshInstance instance{&mesh};
+    generate_distance_field_volume_data(std::span{&instance, 1}, local_space_mesh_bounds, distance_field_resolution_scale,
+                                        b_generate_as_if_two_sided, settings, out_data, control);
+}
+
+void generate_distance_field_volume_data(std::span<const MeshInstance> instances, Box local_space_mesh_bounds,
+                                         float distance_field_resolution_scale, bool b_generate_as_if_two_sided,
+                                         BakeSettings const &settings, DistanceFieldVolumeData &out_data,
+                                         DistanceFieldBakeControl *control) {
+
+    if (distance_field_resolution_scale <= 0 || instances.empty()) return; // sanity check
+
+    const bool b_supported_config = DistanceField::dispatch_brick_config(settings.brick_config, [&]<DistanceField::BrickConfig Config>() {
+        bake_distance_field<Config>(instances, local_space_mesh_bounds, distance_field_resolution_scale, b_generate_as_if_two_sided,
+                                    settings, out_data, control);
+    });
+    if (!b_supported_config) {
+        fmt::print(stderr, "Unsupported brick config: {}^3 bricks, {} voxel band\n", settings.brick_config.brick_size,
+                   settings.brick_config.band_size_in_voxels);
+    }
+}
+
+bool merge_distance_field_shards(std::span<const DistanceFieldVolumeData> shards, BakeSettings const &settings,
+                                 DistanceFieldVolumeData &out_data) {
+    if (shards.empty()) return false;
+
+    DistanceFieldVolumeData const &first_shard = shards.front();
+    const DistanceField::Encoding encoding = first_shard.encoding;
+    const DistanceField::BrickConfig brick_config = first_shard.brick_config;
+    const glm::uint32 brick_size_bytes = DistanceField::get_brick_size_bytes(encoding, brick_config);
+
+    DistanceFieldVolumeData merged_data;
+    merged_data.local_space_mesh_bounds = first_shard.local_space_mesh_bounds;
+    merged_data.b_mostly_two_sided = first_shard.b_mostly_two_sided;
+    merged_data.encoding = encoding;
+    merged_data.brick_config = brick_config;
+
+    for (glm::uint32 mip_index = 0; mip_index < DistanceField::NUM_MIPS; ++mip_index) {
+        const glm::uvec3 indirection_dimensions = first_shard.mips[mip_index].indirection_dimensions;
+
+        std::vector<DistanceFieldMipView> shard_mips;
+        for (DistanceFieldVolumeData const &shard : shards) {
+            if (shard.encoding != encoding || shard.brick_config != brick_config ||
+                shard.mips[mip_index].indirection_dimensions != indirection_dimensions) {
+                return false;
+            }
+
+            const auto shard_mip = DistanceFieldMipView::create(shard, mip_index);
+            if (!shard_mip) return false;
+            shard_mips.push_back(*shard_mip);
+        }
+
+        // valid bricks of all shards, in the order pack_mip would have put them
+        struct ShardBrick {
+            std::uint64_t order_key;
+            glm::uint32 indirection_index;
+            DistanceFieldMipView const *shard_mip;
+            glm::uint32 indirection_entry; // brick index, or child block of a split brick
+        };
+        std::vector<ShardBrick> bricks;
+
+        const std::size_t indirection_table_size =
+            std::size_t(indirection_dimensions.x) * indirection_dimensions.y * indirection_dimensions.z;
+        std::vector<glm::uint32> indirection_table(indirection_table_size, DistanceField::INVALID_BRICK_INDEX);
+
+        for (DistanceFieldMipView const &shard_mip : shard_mips) {
+            for (glm::uint32 indirection_index = 0; indirection_index < indirection_table_size; ++indirection_index) {
+                const glm::uint32 indirection_entry = shard_mip.indirection_table[indirection_index];
+                if (indirection_entry == DistanceField::INVALID_BRICK_INDEX) continue;
+
+                const glm::uvec3 brick_coordinate{
+                    indirection_index % indirection_dimensions.x,
+                    indirection_index / indirection_dimensions.x % indirection_dimensions.y,
+                    indirection_index / indirection_dimensions.x / indirection_dimensions.y,
+                };
+                const std::uint64_t order_key = settings.morton_brick_order ? morton_encode(brick_coordinate) : indirection_index;
+                bricks.push_back({order_key, indirection_index, &shard_mip, indirection_entry});
+            }
+        }
+
+        std::ranges::sort(bricks, std::less{}, &ShardBrick::order_key);
+        // shards own disjoint slabs, overlapping ones come from different bakes
+        if (std::ranges::adjacent_find(bricks, std::equal_to{}, &ShardBrick::order_key) != bricks.end()) return false;
+
+        // split bricks bring their child blocks along, children stay right after their parent as in pack_mip
+        std::vector<std::pair<DistanceFieldMipView const *, glm::uint32>> merged_bricks; // shard mip and brick index in it
+        merged_bricks.reserve(bricks.size());
+
+        const auto merge_entry = [&](auto const &merge_entry, DistanceFieldMipView const &shard_mip, glm::uint32 entry) -> glm::uint32 {
+            if (!DistanceField::is_refined_entry(entry)) {
+                merged_bricks.emplace_back(&shard_mip, entry);
+                return glm::uint32(merged_bricks.size() - 1);
+            }
+
+            const glm::uint32 shard_block_offset = entry & ~DistanceField::REFINED_BRICK_FLAG;
+            const std::size_t block_offset = indirection_table.size();
+            indirection_table.resize(block_offset + 8, DistanceField::INVALID_BRICK_INDEX);
+            for (glm::uint32 child_index = 0; child_index < 8; ++child_index) {
+                const glm::uint32 child_entry = shard_mip.indirection_table[shard_block_offset + child_index];
+                if (child_entry == DistanceField::INVALID_BRICK_INDEX) continue;
+                indirection_table[block_offset + child_index] = merge_entry(merge_entry, shard_mip, child_entry);
+            }
+            return DistanceField::REFINED_BRICK_FLAG | glm::uint32(block_offset);
+        };
+
+        for (ShardBrick const &brick : bricks) {
+            indirection_table[brick.indirection_index] = merge_entry(merge_entry, *brick.shard_mip, brick.indirection_entry);
+        }
+
+        const std::size_t indirection_table_bytes = indirection_table.size() * element_size(indirection_table);
+        std::vector<glm::uint8> mip_data(get_mip_data_size(indirection_table_bytes, merged_bricks.size(), encoding, brick_config));
+        glm::uint8 *distance_field_brick_data = mip_data.data() + indirection_table_bytes;
+        glm::uint8 *brick_scale_bias_data = distance_field_brick_data + merged_bricks.size() * brick_size_bytes;
+
+        for (glm::uint32 brick_index = 0; brick_index < merged_bricks.size(); ++brick_index) {
+            auto const &[shard_mip, shard_brick_index] = merged_bricks[brick_index];
+
+            std::memcpy(distance_field_brick_data + std::size_t(brick_index) * brick_size_bytes,
+                        shard_mip->brick_data + std::size_t(shard_brick_index) * brick_size_bytes, brick_size_bytes);
+            if (shard_mip->brick_scale_bias) {
+                std::memcpy(brick_scale_bias_data + std::size_t(brick_index) * sizeof(glm::vec2),
+                            &shard_mip->brick_scale_bias[shard_brick_index], sizeof(glm::vec2));
+            }
+        }
+        std::memcpy(mip_data.data(), indirection_table.data(), indirection_table_bytes);
+
+        // same blob layout as a single bake
+        SparseDistanceFieldMip &out_mip = merged_data.mips[mip_index];
+        out_mip = first_shard.mips[mip_index];
+        out_mip.num_distance_field_bricks = merged_bricks.size();
+        out_mip.num_refined_bricks = glm::uint32((indirection_table.size() - indirection_table_size) / 8);
+
+        if (mip_index == DistanceField::NUM_MIPS - 1) {
+            out_mip.bulk_offset = out_mip.bulk_size = 0;
+            merged_data.always_loaded_mip = std::move(mip_data);
+        } else {
+            out_mip.bulk_offset = merged_data.streamable_mips.size();
+            out_mip.bulk_size = mip_data.size();
+            merged_data.streamable_mips.insert(merged_data.streamable_mips.end(), mip_data.begin(), mip_data.end());
+        }
+    }
+
+    out_data = std::move(merged_data);
+    return true;
+}
+
+namespace {
+
+/// distance to the combined surface from the distances to both operands, in the local space of the result
+float combine_distances(CsgOperation operation, float distance_a, float distance_b, float smooth_radius) {
+    switch (operation) {
+    case CsgOperation::intersect: return std::max(distance_a, distance_b);
+    case CsgOperation::subtract: return std::max(distance_a, -distance_b);
+    case CsgOperation::smooth_unite:
+        // [I. Quilez; 2013; Smooth minimum], the plain minimum farther apart
+        if (std::abs(distance_a - distance_b) < smooth_radius) {
+            const float blend = 0.5f + 0.5f * (distance_b - distance_a) / smooth_radius;
+            return glm::mix(distance_b, distance_a, blend) - smooth_radius * blend * (1.0f - blend);
+        }
+        [[fallthrough]];
+    default: return std::min(distance_a, distance_b);
+    }
+}
+
+/// whether an indirection entry of `mip` under `bounds` (local space of its volume) holds a brick, split ones included
+bool overlaps_valid_brick(DistanceFieldMipView const &mip, Box const &bounds) {
+    if (glm::any(glm::greaterThan(bounds.min, mip.volume_bounds.max)) || glm::any(glm::lessThan(bounds.max, mip.volume_bounds.min))) {
+        return false;
+    }
+
+    const glm::vec3 indirection_voxel_size = mip.voxel_size * float(mip.brick_config.getUniqueDataBrickSize());
+    const glm::vec3 max_brick_coordinate = glm::vec3(mip.dimensions - 1u);
+    const auto brick_coordinate = [&](glm::vec3 position) {
+        return glm::uvec3{glm::clamp((position - mip.volume_bounds.min) / indirection_voxel_size, glm::vec3(0.0f), max_brick_coordinate)};
+    };
+    const glm::uvec3 min_brick = brick_coordinate(bounds.min), max_brick = brick_coordinate(bounds.max);
+
+    for (glm::uint32 z_index = min_brick.z; z_index <= max_brick.z; ++z_index) {
+        for (glm::uint32 y_index = min_brick.y; y_index <= max_brick.y; ++y_index) {
+            for (glm::uint32 x_index = min_brick.x; x_index <= max_brick.x; ++x_index) {
+                const glm::uint32 indirection_index = compute_linear_voxel_index({x_index, y_index, z_index}, mip.dimensions);
+                if (mip.indirection_table[indirection_index] != DistanceField::INVALID_BRICK_INDEX) return true;
+            }
+        }
+    }
+    return false;
+}
+
+/// invalid indirection entries enclosed by valid ones, deep inside the surface. Packing drops bricks far on either side of it alike,
+/// the invalid entries reached from the border of the volume without crossing a brick are the outside ones
+std::vector<bool> find_interior_entries(DistanceFieldMipView const &mip) {
+    const glm::uvec3 dimensions = mip.dimensions;
+    std::vector<bool> b_interior(std::size_t(dimensions.x) * dimensions.y * dimensions.z);
+    for (std::size_t index = 0; index < b_interior.size(); ++index) {
+        b_interior[index] = mip.indirection_table[index] == DistanceField::INVALID_BRICK_INDEX;
+    }
+
+    std::vector<glm::uvec3> outside_entries;
+    const auto visit = [&](glm::uvec3 coordinate) {
+        const glm::uint32 index = compute_linear_voxel_index(coordinate, dimensions);
+        if (!b_interior[index]) return;
+        b_interior[index] = false;
+        outside_entries.push_back(coordinate);
+    };
+
+    for (glm::uint32 z_index = 0; z_index < dimensions.z; ++z_index) {
+        for (glm::uint32 y_index = 0; y_index < dimensions.y; ++y_index) {
+            for (glm::uint32 x_index = 0; x_index < dimensions.x; ++x_index) {
+                const bool b_border = x_index == 0 || y_index == 0 || z_index == 0 || x_index + 1 == dimensions.x ||
+                                      y_index + 1 == dimensions.y || z_index + 1 == dimensions.z;
+                if (b_border) visit({x_index, y_index, z_index});
+            }
+        }
+    }
+
+    while (!outside_entries.empty()) {
+        const glm::uvec3 coordinate = outside_entries.back();
+        outside_entries.pop_back();
+        for (glm::uint32 axis = 0; axis < 3; ++axis) {
+            glm::uvec3 offset{0u};
+            offset[axis] = 1;
+            if (coordinate[axis] > 0) visit(coordinate - offset);
+            if (coordinate[axis] + 1 < dimensions[axis]) visit(coordinate + offset);
+        }
+    }
+    return b_interior;
+}
+
+/// one volume of combine_distance_fields, sampled in its own local space. Far from the surface a mip only stores its max distance,
+/// on either side: coarser mips, which cover more around the mesh and whose band reaches deeper, take over there, then whether the
+/// entry of the coarsest one is enclosed by bricks tells the side. Two-sided volumes have no inside
+class CsgOperand {
+public:
+    explicit CsgOperand(DistanceFieldVolumeData const &volume_data) : b_two_sided_{volume_data.b_mostly_two_sided} {
+        for (glm::uint32 mip_index = 0; mip_index < DistanceField::NUM_MIPS; ++mip_index) {
+            const auto mip = DistanceFieldMipView::create(volume_data, mip_index);
+            if (!mip) return;
+
+            mips_.push_back(*mip);
+            samplers_.emplace_back(*mip, volume_data.local_space_mesh_bounds);
+            max_distances_.push_back((mip->distance_field_to_volume_scale_bias.x + mip->distance_field_to_volume_scale_bias.y) *
+                                     max_component(volume_data.local_space_mesh_bounds.getExtent()));
+        }
+        if (!b_two_sided_) b_interior_entries_ = find_interior_entries(mips_.back());
+    }
+
+    /// false for volumes of stopped progressive bakes
+    [[nodiscard]] bool isComplete() const { return mips_.size() == DistanceField::NUM_MIPS; }
+
+    [[nodiscard]] DistanceFieldMipView const &getMip(glm::uint32 mip_index) const { return mips_[mip_index]; }
+
+    /// local space distance from a mip. Where no mip knows it, a lower bound: the max distance of the saturated mips or the distance
+    /// to the volume, which keeps the combined volume underestimating distances as a baked one does
+    [[nodiscard]] float sample(glm::uint32 mip_index, glm::vec3 local_position) const {
+        constexpr float saturated_fraction = 0.999f;
+
+        float min_distance = 0.0f; // max distance of the finer mips saturated here
+        bool b_inside = false;
+        for (glm::uint32 sample_mip_index = mip_index; sample_mip_index < DistanceField::NUM_MIPS; ++sample_mip_index) {
+            DistanceFieldMipView const &mip = mips_[sample_mip_index];
+            const float max_distance = max_distances_[sample_mip_index];
+            if (!isInVolume(mip, local_position)) continue; // the sampler would clamp to its border
+
+            if (mip.indirection_table[getIndirectionIndex(mip, local_position)] == DistanceField::INVALID_BRICK_INDEX) {
+                min_distance = std::max(min_distance, max_distance);
+                continue;
+            }
+
+            const float distance = samplers_[sample_mip_index].sample(local_position);
+            if (std::abs(distance) >= saturated_fraction * max_distance) {
+                min_distance = std::max(min_distance, max_distance);
+                b_inside = b_inside || distance < 0.0f;
+                continue;
+            }
+            return distance < 0.0f ? std::min(distance, -min_distance) : std::max(distance, min_distance);
+        }
+
+        DistanceFieldMipView const &coarsest_mip = mips_.back();
+        const glm::vec3 outside_offset = glm::max(glm::max(coarsest_mip.volume_bounds.min - local_position,
+                                                           local_position - coarsest_mip.volume_bounds.max),
+                                                  glm::vec3(0.0f));
+        const float far_distance = std::max(min_distance, glm::length(outside_offset));
+        if (b_inside) return -far_distance;
+        if (!b_two_sided_ && isInVolume(coarsest_mip, local_position) &&
+            b_interior_entries_[getIndirectionIndex(coarsest_mip, local_position)]) {
+            return -far_distance;
+        }
+        return far_distance;
+    }
+
+private:
+    /// within half a voxel, border voxels of a volume with the same layout land on either side of its bounds by rounding
+    static bool isInVolume(DistanceFieldMipView const &mip, glm::vec3 local_position) {
+        const Box volume_bounds = mip.volume_bounds.expandBy(0.5f * mip.voxel_size);
+        return !glm::any(glm::lessThan(local_position, volume_bounds.min)) &&
+               !glm::any(glm::greaterThan(local_position, volume_bounds.max));
+    }
+
+    /// entry the sampler reads at `local_position`
+    static glm::uint32 getIndirectionIndex(DistanceFieldMipView const &mip, glm::vec3 local_position) {
+        const glm::vec3 indirection_voxel_size = mip.voxel_size * float(mip.brick_config.getUniqueDataBrickSize());
+        const glm::uvec3 brick_coordinate = glm::min(
+            glm::uvec3(glm::max((local_position - mip.volume_bounds.min) / indirection_voxel_size, glm::vec3(0.0f))), mip.dimensions - 1u);
+        return compute_linear_voxel_index(brick_coordinate, mip.dimensions);
+    }
+
+    bool b_two_sided_;
+    std::vector<DistanceFieldMipView> mips_;
+    std::vector<DistanceFieldSampler> samplers_;
+    std::vector<float> max_distances_;     // local space, what each mip stores beyond its trace distance
+    std::vector<bool> b_interior_entries_; // of the coarsest mip
+};
+
+Box transform_box(glm::mat4x3 const &transform, Box const &box) {
+    Box transformed_box{glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max())};
+    for (glm::uint32 corner = 0; corner < 8; ++corner) {
+        const glm::vec3 position{corner & 1 ? box.max.x : box.min.x, corner & 2 ? box.max.y : box.min.y,
+                                 corner & 4 ? box.max.z : box.min.z};
+        const glm::vec3 transformed_position = transform * glm::vec4(position, 1.0f);
+        transformed_box.min = glm::min(transformed_box.min, transformed_position);
+        transformed_box.max = glm::max(transformed_box.max, transformed_position);
+    }
+    return transformed_box;
+}
+
+/// a brick of the result grid with an operand near it
+struct CombinedBrick {
+    glm::uvec3 brick_coordinate;
+    std::uint64_t order_key;
+    glm::uint8 brick_max_distance = MIN_UINT8;
+    glm::uint8 brick_min_distance = MAX_UINT8;
+    std::vector<glm::uint16> distance_field_volume; // normalized distance at 16 bits, as baked bricks before packing
+
+    [[nodiscard]] bool isValid() const { return brick_max_distance > MIN_UINT8 && brick_min_distance < MAX_UINT8; }
+};
+
+template <DistanceField::BrickConfig Config>
+bool combine_volumes(DistanceFieldVolumeData const &a, DistanceFieldVolumeData const &b, CsgSettings const &settings,
+                     DistanceFieldVolumeData &out_data) {
+    constexpr glm::uint32 brick_size = Config.brick_size;
+    constexpr glm::uint32 unique_data_brick_size = Config.getUniqueDataBrickSize();
+    constexpr glm::uint32 brick_voxel_count = Config.getBrickVoxelCount();
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    const CsgOperand operand_a{a}, operand_b{b};
+    if (!operand_a.isComplete() || !operand_b.isComplete()) return false;
+
+    const DistanceField::Encoding encoding = a.encoding;
+    const glm::uint32 brick_size_bytes = DistanceField::get_brick_size_bytes(encoding, Config);
+
+    const glm::mat3 inverse_linear_part = glm::inverse(glm::mat3{settings.b_to_a});
+    const glm::mat4x3 a_to_b{inverse_linear_part[0], inverse_linear_part[1], inverse_linear_part[2],
+                             -(inverse_linear_part * settings.b_to_a[3])};
+    const float b_to_a_distance_scale = 1.0f / get_max_stretch(a_to_b); // never overestimates under non-uniform scaling
+
+    // unions cover both operands, whatever else is left lies within a
+    Box local_space_mesh_bounds = a.local_space_mesh_bounds;
+    if (settings.operation == CsgOperation::unite || settings.operation == CsgOperation::smooth_unite) {
+        const Box b_bounds = transform_box(settings.b_to_a, b.local_space_mesh_bounds);
+        local_space_mesh_bounds.min = glm::min(local_space_mesh_bounds.min, b_bounds.min);
+        local_space_mesh_bounds.max = glm::max(local_space_mesh_bounds.max, b_bounds.max);
+    }
+
+    // voxel size of mip 0 of a, so the grid over the bounds of a alone is the one of a
+    const glm::vec3 a_voxel_size = a.local_space_mesh_bounds.getSize() /
+                                   glm::vec3(a.mips[0].indirection_dimensions * unique_data_brick_size -
+                                             2 * DistanceField::MESH_DISTANCE_FIELD_OBJECT_BORDER);
+    const glm::vec3 desired_dimensions =
+        (local_space_mesh_bounds.getSize() / a_voxel_size + float(2 * DistanceField::MESH_DISTANCE_FIELD_OBJECT_BORDER)) /
+        float(unique_data_brick_size);
+    const glm::uvec3 mip0_indirection_dimensions =
+        glm::clamp((glm::uvec3) glm::round(desired_dimensions), 1u, DistanceField::MAX_INDIRECTION_DIMENSION);
+
+    const float local_to_volume_scale = 1.0f / max_component(local_space_mesh_bounds.getExtent());
+
+    DistanceFieldVolumeData combined_data;
+    combined_data.local_space_mesh_bounds = local_space_mesh_bounds;
+    combined_data.b_mostly_two_sided = a.b_mostly_two_sided || b.b_mostly_two_sided;
+    combined_data.encoding = encoding;
+    combined_data.brick_config = Config;
+
+    std::size_t num_total_bricks = 0, num_resampled_bricks = 0, num_valid_bricks = 0;
+
+    for (glm::uint32 mip_index = 0; mip_index < DistanceField::NUM_MIPS; ++mip_index) {
+        DistanceFieldMipView const &mip_a = operand_a.getMip(mip_index);
+        DistanceFieldMipView const &mip_b = operand_b.getMip(mip_index);
+
+        // same layout as bake_distance_field
+        const glm::uvec3 indirection_dimensions{
+            divide_and_round_up(mip0_indirection_dimensions.x, 1u << mip_index),
+            divide_and_round_up(mip0_indirection_dimensions.y, 1u << mip_index),
+            divide_and_round_up(mip0_indirection_dimensions.z, 1u << mip_index),
+        };
+        const glm::vec3 voxel_size = local_space_mesh_bounds.getSize() / glm::vec3(indirection_dimensions * unique_data_brick_size -
+                                                                                   2 * DistanceField::MESH_DISTANCE_FIELD_OBJECT_BORDER);
+        const Box distance_field_volume_bounds = local_space_mesh_bounds.expandBy(voxel_size);
+        const float local_space_trace_distance = glm::length(voxel_size) * Config.band_size_in_voxels;
+        const float volume_space_max_encoding = local_space_trace_distance * local_to_volume_scale;
+
+        // both operands far from a brick leave it at the max encoded distance whatever the operation, it stays invalid. Smooth unions
+        // bridge gaps up to `smooth_radius` wide, with a surface away from both operands: their bricks are searched that much farther
+        const float smooth_search_distance = settings.operation == CsgOperation::smooth_unite ? settings.smooth_radius : 0.0f;
+        std::vector<CombinedBrick> bricks;
+        for (glm::uint32 z_index = 0; z_index < indirection_dimensions.z; ++z_index) {
+            for (glm::uint32 y_index = 0; y_index < indirection_dimensions.y; ++y_index) {
+                for (glm::uint32 x_index = 0; x_index < indirection_dimensions.x; ++x_index) {
+                    const glm::uvec3 brick_coordinate{x_index, y_index, z_index};
+                    const glm::vec3 brick_min_position =
+                        distance_field_volume_bounds.min + glm::vec3(brick_coordinate * unique_data_brick_size) * voxel_size;
+                    const Box brick_bounds{brick_min_position, brick_min_position + float(unique_data_brick_size) * voxel_size};
+                    const Box search_bounds = brick_bounds.expandBy(glm::vec3(smooth_search_distance));
+
+                    // trilinear taps reach one voxel of the operands around the brick
+                    if (overlaps_valid_brick(mip_a, search_bounds.expandBy(mip_a.voxel_size)) ||
+                        overlaps_valid_brick(mip_b, transform_box(a_to_b, search_bounds).expandBy(mip_b.voxel_size))) {
+                        const std::uint64_t order_key = settings.morton_brick_order
+                                                            ? morton_encode(brick_coordinate)
+                                                            : compute_linear_voxel_index(brick_coordinate, indirection_dimensions);
+                        bricks.push_back({brick_coordinate, order_key});
+                    }
+                }
+            }
+        }
+
+        const auto resample_brick = [&](CombinedBrick &brick) {
+            brick.distance_field_volume.resize(brick_voxel_count);
+            const glm::vec3 brick_min_position =
+                distance_field_volume_bounds.min + glm::vec3(brick.brick_coordinate * unique_data_brick_size) * voxel_size;
+
+            for (glm::uint32 z_index = 0; z_index < brick_size; ++z_index) {
+                for (glm::uint32 y_index = 0; y_index < brick_size; ++y_index) {
+                    for (glm::uint32 x_index = 0; x_index < brick_size; ++x_index) {
+                        const glm::vec3 sample_position = glm::vec3(x_index, y_index, z_index) * voxel_size + brick_min_position;
+                        const glm::uint32 index = z_index * brick_size * brick_size + y_index * brick_size + x_index;
+
+                        const float distance_a = operand_a.sample(mip_index, sample_position);
+                        const float distance_b =
+                            operand_b.sample(mip_index, a_to_b * glm::vec4(sample_position, 1.0f)) * b_to_a_distance_scale;
+                        const float distance = combine_distances(settings.operation, distance_a, distance_b, settings.smooth_radius);
+
+                        const float rescaled_distance =
+                            glm::clamp((distance + local_space_trace_distance) / (2 * local_space_trace_distance), 0.0f, 1.0f);
+                        const auto quantized_distance = glm::uint8(glm::round(rescaled_distance * 255.0f));
+
+                        brick.distance_field_volume[index] = glm::uint16(glm::round(rescaled_distance * MAX_UINT16_FLOAT));
+                        brick.brick_min_distance = glm::min(brick.brick_min_distance, quantized_distance);
+                        brick.brick_max_distance = glm::max(brick.brick_max_distance, quantized_distance);
+                    }
+                }
+            }
+        };
+        if (settings.parallel) {
+            std::for_each(std::execution::par, bricks.begin(), bricks.end(), resample_brick);
+        } else {
+            std::for_each(bricks.begin(), bricks.end(), resample_brick);
+        }
+
+        // packed as pack_mip would, without split bricks
+        const std::size_t indirection_table_size =
+            std::size_t(indirection_dimensions.x) * indirection_dimensions.y * indirection_dimensions.z;
+        num_total_bricks += indirection_table_size;
+        num_resampled_bricks += bricks.size();
+        std::erase_if(bricks, [](CombinedBrick const &brick) { return !brick.isValid(); });
+        std::ranges::sort(bricks, std::less{}, &CombinedBrick::order_key);
+        num_valid_bricks += bricks.size();
+
+        std::vector<glm::uint32> indirection_table(indirection_table_size, DistanceField::INVALID_BRICK_INDEX);
+        for (glm::uint32 brick_index = 0; brick_index < bricks.size(); ++brick_index) {
+            indirection_table[compute_linear_voxel_index(bricks[brick_index].brick_coordinate, indirection_dimensions)] = brick_index;
+        }
+
+        const std::size_t indirection_table_bytes = indirection_table.size() * element_size(indirection_table);
+        std::vector<glm::uint8> mip_data(get_mip_data_size(indirection_table_bytes, bricks.size(), encoding, Config));
+        glm::uint8 *distance_field_brick_data = mip_data.data() + indirection_table_bytes;
+        glm::uint8 *brick_scale_bias_data = distance_field_brick_data + bricks.size() * brick_size_bytes;
+
+        const auto encode_brick_at = [&](CombinedBrick const &brick) {
+            const std::size_t brick_index = &brick - bricks.data();
+            const glm::vec2 brick_scale_bias = encode_brick<Config>(brick.distance_field_volume, encoding,
+                                                                    &distance_field_brick_data[brick_index * brick_size_bytes]);
+            if (DistanceField::has_brick_scale_bias(encoding)) {
+                std::memcpy(brick_scale_bias_data + brick_index * sizeof(glm::vec2), &brick_scale_bias, sizeof(glm::vec2));
+            }
+        };
+        if (settings.parallel) {
+            std::for_each(std::execution::par, bricks.begin(), bricks.end(), encode_brick_at);
+        } else {
+            std::for_each(bricks.begin(), bricks.end(), encode_brick_at);
+        }
+        std::memcpy(mip_data.data(), indirection_table.data(), indirection_table_bytes);
+
+        SparseDistanceFieldMip &out_mip = combined_data.mips[mip_index];
+        out_mip.indirection_dimensions = indirection_dimensions;
+        out_mip.num_distance_field_bricks = bricks.size();
+        out_mip.num_refined_bricks = 0;
+        out_mip.distance_field_to_volume_scale_bias = glm::vec2{2 * volume_space_max_encoding, -volume_space_max_encoding};
+
+        const glm::vec3 virtual_uv_min =
+            glm::vec3(DistanceField::MESH_DISTANCE_FIELD_OBJECT_BORDER) / glm::vec3(indirection_dimensions * unique_data_brick_size);
+        const glm::vec3 virtual_uv_size =
+            glm::vec3(indirection_dimensions * unique_data_brick_size - 2 * DistanceField::MESH_DISTANCE_FIELD_OBJECT_BORDER) /
+            glm::vec3(indirection_dimensions * unique_data_brick_size);
+        const glm::vec3 volume_space_extent = local_space_mesh_bounds.getExtent() * local_to_volume_scale;
+
+        out_mip.volume_to_virtual_uv_scale = virtual_uv_size / (2.0f * volume_space_extent);
+        out_mip.volume_to_virtual_uv_add = volume_space_extent * out_mip.volume_to_virtual_uv_scale + virtual_uv_min;
+
+        if (mip_index == DistanceField::NUM_MIPS - 1) {
+            out_mip.bulk_offset = out_mip.bulk_size = 0;
+            combined_data.always_loaded_mip = std::move(mip_data);
+        } else {
+            out_mip.bulk_offset = combined_data.streamable_mips.size();
+            out_mip.bulk_size = mip_data.size();
+            combined_data.streamable_mips.insert(combined_data.streamable_mips.end(), mip_data.begin(), mip_data.end());
+        }
+    }
+
+    out_data = std::move(combined_data);
+
+    auto end_time = std::chrono::steady_clock::now();
+    fmt::print("Combined distance fields in {:.1f}ms, {} of {} bricks resampled, {} valid.\n",
+               std::chrono::duration<double, std::milli>(end_time - start_time).count(), num_resampled_bricks, num_total_bricks,
+               num_valid_bricks);
+    return true;
+}
+
+} // namespace
+
+bool combine_distance_fields(DistanceFieldVolumeData const &a, DistanceFieldVolumeData const &b, CsgSettings const &settings,
+                             DistanceFieldVolumeData &out_data) {
+    bool b_combined = false;
+    const bool b_supported_config = DistanceField::dispatch_brick_config(
+        a.brick_config, [&]<DistanceField::BrickConfig Config>() { b_combined = combine_volumes<Config>(a, b, settings, out_data); });
+    if (!b_supported_config) {
+        fmt::print(stderr, "Unsupported brick config: {}^3 bricks, {} voxel band\n", a.brick_config.brick_size,
+                   a.brick_config.band_size_in_voxels);
+    }
+    return b_combined;
+}
+
+#include "serializer.hpp"
+
+void DistanceFieldVolumeData::serialize(std::ostream &os, DistanceFieldVolumeData const &data) {
+    ::serialize(os, SERIALIZED_MAGIC);
+    ::serialize(os, SERIALIZED_VERSION);
+    ::serialize(os, data.local_space_mesh_bounds);
+    ::serialize(os, data.b_mostly_two_sided);
+    ::serialize(os, data.encoding);
+    ::serialize(os, data.brick_config);
+    ::serialize(os, data.mips);
+    ::serialize(os, data.always_loaded_mip);
+    ::serialize(os, data.streamable_mips);
+}
+
+bool DistanceFieldVolumeData::deserialize(std::istream &is, DistanceFieldVolumeData &data) {
+    if (!deserializeHeader(is, data)) return false;
+    ::deserialize(is, data.streamable_mips);
+    return bool(is);
+}
+
+bool DistanceFieldVolumeData::deserializeHeader(std::istream &is, DistanceFieldVolumeData &data) {
+    // files of older versions lack fields, read as they are they would shift every later one
+    glm::uint32 magic = 0, version = 0;
+    ::deserialize(is, magic);
+    ::deserialize(is, version);
+    if (!is || magic != SERIALIZED_MAGIC || version != SERIALIZED_VERSION) return false;
+
+    ::deserialize(is, data.local_space_mesh_bounds);
+    ::deserialize(is, data.b_mostly_two_sided);
+    ::deserialize(is, data.encoding);
+    ::deserialize(is, data.brick_config);
+    ::deserialize(is, data.mips);
+    ::deserialize(is, data.always_loaded_mip);
+    return bool(is);
+}
@@ -0,0 +1,117 @@
+#include "mapped_file.h"
+
+#include <cstdint>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const char *file_path) {
+#ifdef _WIN32
+    HANDLE file_handle = CreateFileA(file_path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) return;
+
+    LARGE_INTEGER file_size;
+    HANDLE mapping_handle = nullptr;
+    if (GetFileSizeEx(file_handle, &file_size) && file_size.QuadPart > 0) {
+        mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (mapping_handle != nullptr) {
+        data_ = (const char *) MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    }
+
+    if (data_ == nullptr) {
+        if (mapping_handle != nullptr) CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        return;
+    }
+
+    size_ = (std::size_t) file_size.QuadPart;
+    file_handle_ = file_handle;
+    mapping_handle_ = mapping_handle;
+#else
+    const int file_descriptor = open(file_path, O_RDONLY);
+    if (file_descriptor < 0) return;
+
+    struct stat file_stat {};
+    if (fstat(file_descriptor, &file_stat) == 0 && file_stat.st_size > 0) {
+        void *data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        if (data != MAP_FAILED) {
+            // the whole file is read at once by many threads
+            madvise(data, file_stat.st_size, MADV_WILLNEED);
+            data_ = (const char *) data;
+            size_ = file_stat.st_size;
+        }
+    }
+
+    close(file_descriptor); // the mapping keeps the file alive
+#endif
+}
+
+MappedFile::~MappedFile() {
+    if (data_ == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_handle_);
+    CloseHandle(file_handle_);
+#else
+    munmap((void *) data_, size_);
+#endif
+}
+
+MappedOutputFile::MappedOutputFile(const char *file_path, std::size_t size) {
+    if (size == 0) return;
+
+#ifdef _WIN32
+    HANDLE file_handle = CreateFileA(file_path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) return;
+
+    // the mapping grows the file to its size
+    HANDLE mapping_handle =
+        CreateFileMappingA(file_handle, nullptr, PAGE_READWRITE, DWORD(std::uint64_t(size) >> 32), DWORD(size & 0xffffffff), nullptr);
+    if (mapping_handle != nullptr) {
+        data_ = (char *) MapViewOfFile(mapping_handle, FILE_MAP_WRITE, 0, 0, size);
+    }
+
+    if (data_ == nullptr) {
+        if (mapping_handle != nullptr) CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        return;
+    }
+
+    size_ = size;
+    file_handle_ = file_handle;
+    mapping_handle_ = mapping_handle;
+#else
+    const int file_descriptor = open(file_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file_descriptor < 0) return;
+
+    if (ftruncate(file_descriptor, (off_t) size) == 0) {
+        void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+        if (data != MAP_FAILED) {
+            data_ = (char *) data;
+            size_ = size;
+        }
+    }
+
+    close(file_descriptor);
+#endif
+}
+
+MappedOutputFile::~MappedOutputFile() {
+    if (data_ == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_handle_);
+    CloseHandle(file_handle_);
+#else
+    munmap(data_, size_);
+#endif
+}
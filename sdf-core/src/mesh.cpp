@@ -0,0 +1,438 @@
+#include "mesh.h"
+#include "mesh_reader.h"
+#include "sdf_math.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <execution>
+#include <filesystem>
+#include <numeric>
+#include <string>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h> // Post processing flags
+#include <assimp/scene.h>       // Output data structure
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+Box Mesh::getExpandedBoundingBox() const {
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{-std::numeric_limits<float>::max()};
+
+    for (const auto &vertex : vertices) {
+        min = glm::min(min, vertex);
+        max = glm::max(max, vertex);
+    }
+
+    return {
+        .min = min + (min - max) / 4.0f,
+        .max = max + (max - min) / 4.0f,
+    };
+}
+
+Box Mesh::getAABB() const {
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{-std::numeric_limits<float>::max()};
+
+    for (const auto &vertex : vertices) {
+        min = glm::min(min, vertex);
+        max = glm::max(max, vertex);
+    }
+
+    return {min, max};
+}
+
+Mesh Mesh::translate(glm::vec3 displacement) const {
+    std::vector<glm::vec3> out_verts(vertices.size());
+
+    std::transform(std::execution::par_unseq, vertices.cbegin(), vertices.cend(), out_verts.begin(),
+                   [displacement](glm::vec3 v) { return v + displacement; });
+    return Mesh{std::move(out_verts), indices};
+}
+
+Box MeshInstance::getAABB() const {
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{-std::numeric_limits<float>::max()};
+
+    for (const auto &vertex : mesh->vertices) {
+        const glm::vec3 transformed_vertex = transform * glm::vec4(vertex, 1.0f);
+        min = glm::min(min, transformed_vertex);
+        max = glm::max(max, transformed_vertex);
+    }
+
+    return {min, max};
+}
+
+Mesh Mesh::extractTriangles(std::span<const glm::uint32> triangle_indices) const {
+    constexpr glm::uint32 unmapped_vertex = std::numeric_limits<glm::uint32>::max();
+    std::vector<glm::uint32> vertex_remap(vertices.size(), unmapped_vertex);
+
+    Mesh result;
+    result.indices.reserve(triangle_indices.size());
+
+    for (const glm::uint32 triangle_index : triangle_indices) {
+        glm::uvec3 triangle = indices[triangle_index];
+        for (glm::uint32 k = 0; k < 3; ++k) {
+            glm::uint32 &remapped_index = vertex_remap[triangle[k]];
+            if (remapped_index == unmapped_vertex) {
+                remapped_index = result.vertices.size();
+                result.vertices.push_back(vertices[triangle[k]]);
+            }
+            triangle[k] = remapped_index;
+        }
+        result.indices.push_back(triangle);
+    }
+
+    return result;
+}
+
+namespace {
+
+bool lexicographic_less(glm::vec3 lhs, glm::vec3 rhs) {
+    if (lhs.x != rhs.x) return lhs.x < rhs.x;
+    if (lhs.y != rhs.y) return lhs.y < rhs.y;
+    return lhs.z < rhs.z;
+}
+
+struct Edge {
+    glm::vec3 a, b;
+
+    bool operator<(Edge const &rhs) const {
+        if (a != rhs.a) return lexicographic_less(a, rhs.a);
+        return lexicographic_less(b, rhs.b);
+    }
+    bool operator==(Edge const &rhs) const { return a == rhs.a && b == rhs.b; }
+};
+
+} // namespace
+
+bool Mesh::isMostlyTwoSided() const {
+    // key edges by position rather than index, importers may split vertices on seams
+    std::vector<Edge> edges(indices.size() * 3);
+    double surface_area = 0;
+
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        const glm::uvec3 triangle = indices[i];
+        for (glm::uint32 k = 0; k < 3; ++k) {
+            const glm::vec3 start = vertices[triangle[k]];
+            const glm::vec3 end = vertices[triangle[(k + 1) % 3]];
+            edges[i * 3 + k] = lexicographic_less(start, end) ? Edge{start, end} : Edge{end, start};
+        }
+        const glm::dvec3 A = vertices[triangle.x], B = vertices[triangle.y], C = vertices[triangle.z];
+        surface_area += 0.5 * glm::length(glm::cross(B - A, C - A));
+    }
+
+    std::sort(std::execution::par_unseq, edges.begin(), edges.end());
+
+    // boundary edges are referenced by a single triangle
+    double boundary_length = 0;
+    for (std::size_t i = 0; i < edges.size();) {
+        std::size_t j = i + 1;
+        while (j < edges.size() && edges[j] == edges[i]) ++j;
+        if (j - i == 1) boundary_length += glm::length(glm::dvec3(edges[i].b - edges[i].a));
+        i = j;
+    }
+
+    // a square sheet gets 4, a closed mesh with a few small holes stays well below 1
+    const double max_closed_boundary_ratio = 1.0;
+    return surface_area > 0 && boundary_length > max_closed_boundary_ratio * std::sqrt(surface_area);
+}
+
+Mesh Mesh::preprocess(float weld_distance) const {
+    const Box aabb = getAABB();
+
+    // weld, sorting vertices by position for exact welds, or by `weld_distance` grid cell brings together those to compare. Cells
+    // are keyed (z, y, x) so that each row of three neighbouring cells along x is a single run of the sorted vertices
+    std::vector<glm::vec3> weld_keys(vertices.size());
+    std::transform(std::execution::par_unseq, vertices.cbegin(), vertices.cend(), weld_keys.begin(), [&](glm::vec3 vertex) {
+        if (weld_distance == 0) return vertex;
+        const glm::vec3 cell = glm::floor((vertex - aabb.min) / weld_distance);
+        return glm::vec3{cell.z, cell.y, cell.x};
+    });
+
+    std::vector<glm::uint32> sorted_vertices(vertices.size());
+    std::iota(sorted_vertices.begin(), sorted_vertices.end(), 0);
+    std::sort(std::execution::par_unseq, sorted_vertices.begin(), sorted_vertices.end(), [&](glm::uint32 lhs, glm::uint32 rhs) {
+        if (weld_keys[lhs] != weld_keys[rhs]) return lexicographic_less(weld_keys[lhs], weld_keys[rhs]);
+        return lhs < rhs;
+    });
+
+    std::vector<glm::uint32> weld_remap(vertices.size());
+    if (weld_distance == 0) {
+        // equal vertices all map to the lowest index among them
+        for (std::size_t i = 0; i < sorted_vertices.size();) {
+            std::size_t j = i;
+            for (; j < sorted_vertices.size() && weld_keys[sorted_vertices[j]] == weld_keys[sorted_vertices[i]]; ++j) {
+                weld_remap[sorted_vertices[j]] = sorted_vertices[i];
+            }
+            i = j;
+        }
+    } else {
+        // candidates of a vertex are the lower index ones within `weld_distance`, found in parallel. They lie in the 9 rows of cells
+        // around it
+        const auto key_less = [&weld_keys](glm::uint32 vertex, glm::vec3 key) { return lexicographic_less(weld_keys[vertex], key); };
+        const float weld_distance_sq = weld_distance * weld_distance;
+        const auto for_each_candidate = [&](glm::uint32 vertex, auto const &function) {
+            for (glm::uint32 row = 0; row < 9; ++row) {
+                const glm::vec3 row_key = weld_keys[vertex] + glm::vec3(float(row % 3) - 1.0f, float(row / 3) - 1.0f, 0.0f);
+                const glm::vec3 row_last_key = row_key + glm::vec3(0.0f, 0.0f, 1.0f);
+                auto candidate = std::lower_bound(sorted_vertices.begin(), sorted_vertices.end(),
+                                                  row_key - glm::vec3(0.0f, 0.0f, 1.0f), key_less);
+                for (; candidate != sorted_vertices.end() && !lexicographic_less(row_last_key, weld_keys[*candidate]); ++candidate) {
+                    const glm::vec3 offset = vertices[*candidate] - vertices[vertex];
+                    if (*candidate < vertex && glm::dot(offset, offset) <= weld_distance_sq) function(*candidate);
+                }
+            }
+        };
+
+        std::vector<std::size_t> candidate_offsets(vertices.size() + 1, 0);
+        std::for_each(std::execution::par, sorted_vertices.cbegin(), sorted_vertices.cend(), [&](glm::uint32 vertex) {
+            for_each_candidate(vertex, [&](glm::uint32 /*unused*/) { ++candidate_offsets[vertex + 1]; });
+        });
+        std::inclusive_scan(candidate_offsets.begin(), candidate_offsets.end(), candidate_offsets.begin());
+
+        std::vector<glm::uint32> candidates(candidate_offsets.back());
+        std::for_each(std::execution::par, sorted_vertices.cbegin(), sorted_vertices.cend(), [&](glm::uint32 vertex) {
+            std::size_t candidate_index = candidate_offsets[vertex];
+            for_each_candidate(vertex, [&](glm::uint32 candidate) { candidates[candidate_index++] = candidate; });
+            std::sort(candidates.begin() + candidate_offsets[vertex], candidates.begin() + candidate_offsets[vertex + 1]);
+        });
+
+        // in index order, each vertex maps to its lowest candidate not welded itself, so none moves farther through a chain
+        for (glm::uint32 vertex = 0; vertex < vertices.size(); ++vertex) {
+            weld_remap[vertex] = vertex;
+            for (std::size_t i = candidate_offsets[vertex]; i < candidate_offsets[vertex + 1]; ++i) {
+                if (weld_remap[candidates[i]] == candidates[i]) {
+                    weld_remap[vertex] = candidates[i];
+                    break;
+                }
+            }
+        }
+    }
+
+    // drop triangles collapsed by the weld or with (almost) zero area
+    const float min_double_area = weld_distance * weld_distance;
+    std::vector<glm::uvec3> welded_triangles(indices.size());
+    std::transform(std::execution::par_unseq, indices.cbegin(), indices.cend(), welded_triangles.begin(), [&](glm::uvec3 triangle) {
+        return glm::uvec3{weld_remap[triangle.x], weld_remap[triangle.y], weld_remap[triangle.z]};
+    });
+
+    std::vector<glm::uint32> kept_triangles(indices.size());
+    std::iota(kept_triangles.begin(), kept_triangles.end(), 0);
+    const auto is_degenerate = [&](glm::uint32 triangle_index) {
+        const glm::uvec3 triangle = welded_triangles[triangle_index];
+        if (triangle.x == triangle.y || triangle.y == triangle.z || triangle.z == triangle.x) return true;
+
+        const glm::vec3 A = vertices[triangle.x], B = vertices[triangle.y], C = vertices[triangle.z];
+        const glm::vec3 cross = glm::cross(B - A, C - A);
+        return glm::dot(cross, cross) <= min_double_area * min_double_area;
+    };
+    kept_triangles.erase(std::remove_if(std::execution::par_unseq, kept_triangles.begin(), kept_triangles.end(), is_degenerate),
+                         kept_triangles.end());
+
+    // drop duplicates, the same three vertices in any order (opposite windings of one surface included)
+    const auto sorted_corners = [&welded_triangles](glm::uint32 triangle_index) {
+        glm::uvec3 corners = welded_triangles[triangle_index];
+        if (corners.x > corners.y) std::swap(corners.x, corners.y);
+        if (corners.y > corners.z) std::swap(corners.y, corners.z);
+        if (corners.x > corners.y) std::swap(corners.x, corners.y);
+        return corners;
+    };
+    const auto corners_less = [&](glm::uint32 lhs, glm::uint32 rhs) {
+        const glm::uvec3 lhs_corners = sorted_corners(lhs), rhs_corners = sorted_corners(rhs);
+        if (lhs_corners.x != rhs_corners.x) return lhs_corners.x < rhs_corners.x;
+        if (lhs_corners.y != rhs_corners.y) return lhs_corners.y < rhs_corners.y;
+        if (lhs_corners.z != rhs_corners.z) return lhs_corners.z < rhs_corners.z;
+        return lhs < rhs;
+    };
+    std::sort(std::execution::par_unseq, kept_triangles.begin(), kept_triangles.end(), corners_less);
+    kept_triangles.erase(std::unique(kept_triangles.begin(), kept_triangles.end(),
+                                     [&](glm::uint32 lhs, glm::uint32 rhs) { return sorted_corners(lhs) == sorted_corners(rhs); }),
+                         kept_triangles.end());
+
+    // sort triangles by the Morton code of their centroid, neighbours in space become neighbours in memory
+    const glm::vec3 morton_scale = float((1u << 21) - 1) / glm::max(aabb.getSize(), glm::vec3{std::numeric_limits<float>::min()});
+    std::vector<std::pair<std::uint64_t, glm::uint32>> morton_triangles(kept_triangles.size());
+    std::transform(std::execution::par_unseq, kept_triangles.cbegin(), kept_triangles.cend(), morton_triangles.begin(),
+                   [&](glm::uint32 triangle_index) {
+                       const glm::uvec3 triangle = welded_triangles[triangle_index];
+                       const glm::vec3 centroid = (vertices[triangle.x] + vertices[triangle.y] + vertices[triangle.z]) / 3.0f;
+                       const glm::uvec3 cell = glm::clamp((centroid - aabb.min) * morton_scale, 0.0f, float((1u << 21) - 1));
+                       return std::pair{morton_encode(cell), triangle_index};
+                   });
+    std::sort(std::execution::par_unseq, morton_triangles.begin(), morton_triangles.end());
+
+    // vertices in order of first use, which follows the curve too and drops unreferenced ones
+    constexpr glm::uint32 unmapped_vertex = std::numeric_limits<glm::uint32>::max();
+    std::vector<glm::uint32> vertex_remap(vertices.size(), unmapped_vertex);
+
+    Mesh result;
+    result.indices.reserve(morton_triangles.size());
+    for (auto const &[morton_code, triangle_index] : morton_triangles) {
+        glm::uvec3 triangle = welded_triangles[triangle_index];
+        for (glm::uint32 k = 0; k < 3; ++k) {
+            glm::uint32 &remapped_index = vertex_remap[triangle[k]];
+            if (remapped_index == unmapped_vertex) {
+                remapped_index = result.vertices.size();
+                result.vertices.push_back(vertices[triangle[k]]);
+            }
+            triangle[k] = remapped_index;
+        }
+        result.indices.push_back(triangle);
+    }
+
+    return result;
+}
+
+std::optional<MeshPseudoNormals> Mesh::computePseudoNormals() const {
+    // exact weld, importers split vertices on seams but the pseudo-normal of a vertex must gather all faces around its position
+    std::vector<glm::uint32> sorted_vertices(vertices.size());
+    std::iota(sorted_vertices.begin(), sorted_vertices.end(), 0);
+    std::sort(std::execution::par_unseq, sorted_vertices.begin(), sorted_vertices.end(), [&](glm::uint32 lhs, glm::uint32 rhs) {
+        if (vertices[lhs] != vertices[rhs]) return lexicographic_less(vertices[lhs], vertices[rhs]);
+        return lhs < rhs;
+    });
+
+    std::vector<glm::uint32> weld_remap(vertices.size());
+    for (std::size_t i = 0; i < sorted_vertices.size();) {
+        std::size_t j = i;
+        for (; j < sorted_vertices.size() && vertices[sorted_vertices[j]] == vertices[sorted_vertices[i]]; ++j) {
+            weld_remap[sorted_vertices[j]] = sorted_vertices[i];
+        }
+        i = j;
+    }
+
+    struct DirectedEdge {
+        glm::uint32 from, to;
+        glm::uint32 triangle_edge; // triangle index * 3 + edge index
+    };
+    std::vector<DirectedEdge> edges;
+    edges.reserve(indices.size() * 3);
+
+    MeshPseudoNormals result;
+    result.face_normals.assign(indices.size(), glm::vec3{0.0f});
+    result.edge_normals.assign(indices.size() * 3, glm::vec3{0.0f});
+    std::vector<glm::dvec3> vertex_sums(vertices.size(), glm::dvec3{0.0});
+
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        const glm::uvec3 triangle{weld_remap[indices[i].x], weld_remap[indices[i].y], weld_remap[indices[i].z]};
+        // collapsed to a point or segment, coincides with the features of its neighbours and takes no part in the topology
+        if (triangle.x == triangle.y || triangle.y == triangle.z || triangle.z == triangle.x) continue;
+
+        for (glm::uint32 k = 0; k < 3; ++k) edges.push_back({triangle[k], triangle[(k + 1) % 3], glm::uint32(i * 3 + k)});
+
+        const glm::dvec3 corners[3] = {vertices[triangle.x], vertices[triangle.y], vertices[triangle.z]};
+        const glm::dvec3 normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+        const double normal_length = glm::length(normal);
+        if (normal_length == 0) continue; // collinear, its edges still pair up with the neighbours'
+        const glm::dvec3 unit_normal = normal / normal_length;
+        result.face_normals[i] = unit_normal;
+
+        for (glm::uint32 k = 0; k < 3; ++k) {
+            const glm::dvec3 to_next = glm::normalize(corners[(k + 1) % 3] - corners[k]);
+            const glm::dvec3 to_previous = glm::normalize(corners[(k + 2) % 3] - corners[k]);
+            const double angle = std::acos(std::clamp(glm::dot(to_next, to_previous), -1.0, 1.0));
+            vertex_sums[triangle[k]] += angle * unit_normal;
+        }
+    }
+
+    // the two directed halves of every undirected edge end up next to each other
+    std::sort(std::execution::par_unseq, edges.begin(), edges.end(), [](DirectedEdge const &lhs, DirectedEdge const &rhs) {
+        const glm::uvec3 lhs_key{std::min(lhs.from, lhs.to), std::max(lhs.from, lhs.to), lhs.from};
+        const glm::uvec3 rhs_key{std::min(rhs.from, rhs.to), std::max(rhs.from, rhs.to), rhs.from};
+        if (lhs_key.x != rhs_key.x) return lhs_key.x < rhs_key.x;
+        if (lhs_key.y != rhs_key.y) return lhs_key.y < rhs_key.y;
+        return lhs_key.z < rhs_key.z;
+    });
+
+    for (std::size_t i = 0; i < edges.size(); i += 2) {
+        if (i + 1 == edges.size()) return std::nullopt;
+        DirectedEdge const &edge = edges[i], &twin = edges[i + 1];
+        if (edge.from != twin.to || edge.to != twin.from) return std::nullopt;
+        if (i + 2 < edges.size() && std::min(edges[i + 2].from, edges[i + 2].to) == std::min(edge.from, edge.to) &&
+            std::max(edges[i + 2].from, edges[i + 2].to) == std::max(edge.from, edge.to)) {
+            return std::nullopt; // shared by more than two triangles
+        }
+
+        const glm::vec3 edge_normal = result.face_normals[edge.triangle_edge / 3] + result.face_normals[twin.triangle_edge / 3];
+        result.edge_normals[edge.triangle_edge] = edge_normal;
+        result.edge_normals[twin.triangle_edge] = edge_normal;
+    }
+
+    result.vertex_normals.resize(vertices.size());
+    std::transform(weld_remap.cbegin(), weld_remap.cend(), result.vertex_normals.begin(),
+                   [&](glm::uint32 welded_vertex) { return glm::vec3(vertex_sums[welded_vertex]); });
+
+    return result;
+}
+
+namespace {
+
+/// every mesh of an Assimp scene, empty if the import failed
+std::vector<Mesh> convert_assimp_scene(const aiScene *scene) {
+    if (scene == nullptr || !scene->HasMeshes()) return {};
+
+    std::vector<Mesh> result(scene->mNumMeshes);
+
+    for (int i = 0; i < scene->mNumMeshes; ++i) {
+        const auto &mesh = scene->mMeshes[i];
+
+        result[i].vertices.resize(mesh->mNumVertices);
+        result[i].indices.resize(mesh->mNumFaces);
+
+        for (int j = 0; j < mesh->mNumVertices; ++j) {
+            result[i].vertices[j] = {
+                mesh->mVertices[j].x,
+                mesh->mVertices[j].y,
+                mesh->mVertices[j].z,
+            };
+        }
+
+        for (int j = 0; j < mesh->mNumFaces; ++j) {
+            auto const &face = mesh->mFaces[j];
+            result[i].indices[j] = {
+                face.mIndices[0],
+                face.mIndices[1],
+                face.mIndices[2],
+            };
+        }
+    }
+
+    return result;
+}
+
+constexpr std::uint32_t ASSIMP_IMPORT_FLAGS = aiProcess_Triangulate | aiProcess_ImproveCacheLocality | aiProcess_RemoveComponent;
+
+} // namespace
+
+std::vector<Mesh> Mesh::importFromFile(const char *file_path, bool b_allow_native_reader) {
+    if (b_allow_native_reader) {
+        std::string extension = std::filesystem::path(file_path).extension().string();
+        std::ranges::transform(extension, extension.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+
+        Mesh mesh;
+        if ((extension == ".ply" && read_ply(file_path, mesh)) || (extension == ".obj" && read_obj(file_path, mesh))) {
+            return {std::move(mesh)};
+        }
+    }
+
+    Assimp::Importer importer;
+    return convert_assimp_scene(importer.ReadFile(file_path, ASSIMP_IMPORT_FLAGS));
+}
+
+std::vector<Mesh> Mesh::importFromMemory(std::string_view file_data, std::string_view extension, bool b_allow_native_reader) {
+    std::string lower_extension{extension};
+    std::ranges::transform(lower_extension, lower_extension.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+
+    if (b_allow_native_reader) {
+        Mesh mesh;
+        if ((lower_extension == "ply" && parse_ply(file_data, mesh)) || (lower_extension == "obj" && parse_obj(file_data, mesh))) {
+            return {std::move(mesh)};
+        }
+    }
+
+    Assimp::Importer importer;
+    const aiScene *scene = importer.ReadFileFromMemory(file_data.data(), file_data.size(), ASSIMP_IMPORT_FLAGS, lower_extension.c_str());
+    return convert_assimp_scene(scene);
+}
\ No newline at end of file
@@ -0,0 +1,584 @@
+#include "mesh_reader.h"
+#include "mapped_file.h"
+#include "mesh.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <execution>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// ---------- parallel helpers -----------
+
+template <typename F>
+void parallel_for_blocks(std::size_t count, F const &block_function) {
+    constexpr std::size_t block_size = 1 << 16;
+
+    std::vector<std::size_t> block_begins;
+    for (std::size_t begin = 0; begin < count; begin += block_size) block_begins.push_back(begin);
+
+    std::for_each(std::execution::par, block_begins.begin(), block_begins.end(),
+                  [count, &block_function](std::size_t begin) { block_function(begin, std::min(begin + block_size, count)); });
+}
+
+/// about 4 ranges per hardware thread, each ending on a line boundary
+std::vector<std::string_view> split_in_line_chunks(std::string_view text) {
+    const std::size_t num_chunks = std::max(4u * std::thread::hardware_concurrency(), 1u);
+    const std::size_t chunk_size = std::max<std::size_t>(text.size() / num_chunks, 1);
+
+    std::vector<std::string_view> chunks;
+    for (std::size_t begin = 0; begin < text.size();) {
+        const std::size_t line_end = text.find('\n', std::min(begin + chunk_size, text.size()) - 1);
+        const std::size_t end = line_end == std::string_view::npos ? text.size() : line_end + 1;
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+
+    return chunks;
+}
+
+std::size_t count_lines(std::string_view chunk) {
+    const auto num_line_feeds = (std::size_t) std::count(chunk.begin(), chunk.end(), '\n');
+    return num_line_feeds + (!chunk.empty() && chunk.back() != '\n' ? 1 : 0);
+}
+
+/// calls `line_function` with every line of the chunk, without line endings
+template <typename F>
+void for_each_line(std::string_view chunk, F &&line_function) {
+    while (!chunk.empty()) {
+        const std::size_t line_end = chunk.find('\n');
+        std::string_view line = chunk.substr(0, line_end);
+        chunk.remove_prefix(line_end == std::string_view::npos ? chunk.size() : line_end + 1);
+
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        line_function(line);
+    }
+}
+
+std::string_view next_token(std::string_view &line) {
+    const std::size_t token_begin = line.find_first_not_of(" \t");
+    if (token_begin == std::string_view::npos) {
+        line = {};
+        return {};
+    }
+
+    line.remove_prefix(token_begin);
+    const std::size_t token_end = std::min(line.find_first_of(" \t"), line.size());
+    const std::string_view token = line.substr(0, token_end);
+    line.remove_prefix(token_end);
+    return token;
+}
+
+template <typename T>
+bool parse_number(std::string_view token, T &value) {
+    if (!token.empty() && token.front() == '+') token.remove_prefix(1); // from_chars rejects explicit plus
+    const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+    return error == std::errc{} && end != token.data();
+}
+
+/// gathers per-chunk triangles into one buffer, in chunk order
+void concatenate_triangles(std::vector<std::vector<glm::uvec3>> const &chunk_triangles, std::vector<glm::uvec3> &out_indices) {
+    std::vector<std::size_t> chunk_offsets(chunk_triangles.size() + 1, 0);
+    for (std::size_t chunk_index = 0; chunk_index < chunk_triangles.size(); ++chunk_index) {
+        chunk_offsets[chunk_index + 1] = chunk_offsets[chunk_index] + chunk_triangles[chunk_index].size();
+    }
+
+    out_indices.resize(chunk_offsets.back());
+
+    std::vector<std::size_t> chunk_indices(chunk_triangles.size());
+    std::iota(chunk_indices.begin(), chunk_indices.end(), 0);
+    std::for_each(std::execution::par, chunk_indices.begin(), chunk_indices.end(), [&](std::size_t chunk_index) {
+        std::ranges::copy(chunk_triangles[chunk_index], out_indices.begin() + (std::ptrdiff_t) chunk_offsets[chunk_index]);
+    });
+}
+
+bool has_valid_indices(Mesh const &mesh) {
+    const auto num_vertices = (glm::uint32) mesh.vertices.size();
+    return std::all_of(std::execution::par_unseq, mesh.indices.begin(), mesh.indices.end(), [num_vertices](glm::uvec3 triangle) {
+        return triangle.x < num_vertices && triangle.y < num_vertices && triangle.z < num_vertices;
+    });
+}
+
+// ---------- PLY -----------
+
+enum class PlyType { int8, uint8, int16, uint16, int32, uint32, float32, float64, invalid };
+
+PlyType parse_ply_type(std::string_view name) {
+    if (name == "char" || name == "int8") return PlyType::int8;
+    if (name == "uchar" || name == "uint8") return PlyType::uint8;
+    if (name == "short" || name == "int16") return PlyType::int16;
+    if (name == "ushort" || name == "uint16") return PlyType::uint16;
+    if (name == "int" || name == "int32") return PlyType::int32;
+    if (name == "uint" || name == "uint32") return PlyType::uint32;
+    if (name == "float" || name == "float32") return PlyType::float32;
+    if (name == "double" || name == "float64") return PlyType::float64;
+    return PlyType::invalid;
+}
+
+std::size_t ply_type_size(PlyType type) {
+    switch (type) {
+    case PlyType::int8:
+    case PlyType::uint8: return 1;
+    case PlyType::int16:
+    case PlyType::uint16: return 2;
+    case PlyType::int32:
+    case PlyType::uint32:
+    case PlyType::float32: return 4;
+    case PlyType::float64: return 8;
+    default: return 0;
+    }
+}
+
+struct PlyProperty {
+    std::string name;
+    PlyType type;
+    bool b_list = false;
+    PlyType count_type = PlyType::invalid;
+};
+
+struct PlyElement {
+    std::string name;
+    std::size_t count;
+    std::vector<PlyProperty> properties;
+
+    /// byte size of one binary record, 0 if it holds lists
+    [[nodiscard]] std::size_t fixedStride() const {
+        std::size_t stride = 0;
+        for (auto const &property : properties) {
+            if (property.b_list) return 0;
+            stride += ply_type_size(property.type);
+        }
+        return stride;
+    }
+
+    [[nodiscard]] std::optional<std::size_t> findProperty(std::string_view property_name) const {
+        for (std::size_t i = 0; i < properties.size(); ++i) {
+            if (properties[i].name == property_name) return i;
+        }
+        return std::nullopt;
+    }
+};
+
+enum class PlyFormat { ascii, binary_little_endian, binary_big_endian };
+
+struct PlyHeader {
+    PlyFormat format;
+    std::vector<PlyElement> elements;
+    std::size_t body_offset;
+};
+
+std::optional<PlyHeader> parse_ply_header(std::string_view file) {
+    if (!file.starts_with("ply")) return std::nullopt;
+
+    PlyHeader header{};
+    bool b_has_format = false;
+
+    std::size_t line_begin = 0;
+    while (line_begin < file.size()) {
+        const std::size_t line_end = file.find('\n', line_begin);
+        if (line_end == std::string_view::npos) return std::nullopt; // no end_header
+
+        std::string_view line = file.substr(line_begin, line_end - line_begin);
+        line_begin = line_end + 1;
+
+        const std::string_view keyword = next_token(line);
+        if (keyword == "format") {
+            const std::string_view format = next_token(line);
+            if (format == "ascii") {
+                header.format = PlyFormat::ascii;
+            } else if (format == "binary_little_endian") {
+                header.format = PlyFormat::binary_little_endian;
+            } else if (format == "binary_big_endian") {
+                header.format = PlyFormat::binary_big_endian;
+            } else {
+                return std::nullopt;
+            }
+            b_has_format = true;
+        } else if (keyword == "element") {
+            PlyElement &element = header.elements.emplace_back();
+            element.name = next_token(line);
+            if (!parse_number(next_token(line), element.count)) return std::nullopt;
+        } else if (keyword == "property") {
+            if (header.elements.empty()) return std::nullopt;
+
+            PlyProperty property;
+            std::string_view type_name = next_token(line);
+            if (type_name == "list") {
+                property.b_list = true;
+                property.count_type = parse_ply_type(next_token(line));
+                type_name = next_token(line);
+                if (property.count_type == PlyType::invalid) return std::nullopt;
+            }
+            property.type = parse_ply_type(type_name);
+            property.name = next_token(line);
+            if (property.type == PlyType::invalid) return std::nullopt;
+
+            header.elements.back().properties.push_back(std::move(property));
+        } else if (keyword == "end_header") {
+            header.body_offset = line_begin;
+            if (!b_has_format) return std::nullopt;
+            return header;
+        }
+        // comment, obj_info
+    }
+
+    return std::nullopt;
+}
+
+template <typename T>
+T load_raw(const char *source, bool b_swap) {
+    std::array<char, sizeof(T)> bytes;
+    std::memcpy(bytes.data(), source, sizeof(T));
+    if (b_swap) std::reverse(bytes.begin(), bytes.end());
+
+    T value;
+    std::memcpy(&value, bytes.data(), sizeof(T));
+    return value;
+}
+
+template <typename T>
+T load_ply_scalar(const char *source, PlyType type, bool b_swap) {
+    switch (type) {
+    case PlyType::int8: return T(load_raw<std::int8_t>(source, b_swap));
+    case PlyType::uint8: return T(load_raw<std::uint8_t>(source, b_swap));
+    case PlyType::int16: return T(load_raw<std::int16_t>(source, b_swap));
+    case PlyType::uint16: return T(load_raw<std::uint16_t>(source, b_swap));
+    case PlyType::int32: return T(load_raw<std::int32_t>(source, b_swap));
+    case PlyType::uint32: return T(load_raw<std::uint32_t>(source, b_swap));
+    case PlyType::float32: return T(load_raw<float>(source, b_swap));
+    case PlyType::float64: return T(load_raw<double>(source, b_swap));
+    default: return T(0);
+    }
+}
+
+/// position of the scalar properties x, y, z in the vertex element, nullopt if it has a list property: records would have no fixed
+/// stride or token count
+struct PlyVertexLayout {
+    std::array<std::size_t, 3> property_indices;
+    std::array<std::size_t, 3> byte_offsets;
+    std::array<PlyType, 3> types;
+};
+
+std::optional<PlyVertexLayout> find_ply_vertex_layout(PlyElement const &vertex_element) {
+    if (std::ranges::any_of(vertex_element.properties, &PlyProperty::b_list)) return std::nullopt;
+
+    PlyVertexLayout layout{};
+    const std::array<const char *, 3> axis_names{"x", "y", "z"};
+
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        const auto property_index = vertex_element.findProperty(axis_names[axis]);
+        if (!property_index) return std::nullopt;
+
+        layout.property_indices[axis] = *property_index;
+        layout.types[axis] = vertex_element.properties[*property_index].type;
+        layout.byte_offsets[axis] = 0;
+        for (std::size_t i = 0; i < *property_index; ++i) layout.byte_offsets[axis] += ply_type_size(vertex_element.properties[i].type);
+    }
+
+    return layout;
+}
+
+std::optional<std::size_t> find_ply_face_list(PlyElement const &face_element) {
+    auto list_index = face_element.findProperty("vertex_indices");
+    if (!list_index) list_index = face_element.findProperty("vertex_index");
+    if (!list_index || !face_element.properties[*list_index].b_list) return std::nullopt;
+
+    // only the index list may have a variable size
+    for (std::size_t i = 0; i < face_element.properties.size(); ++i) {
+        if (i != *list_index && face_element.properties[i].b_list) return std::nullopt;
+    }
+
+    return list_index;
+}
+
+bool read_binary_ply(std::string_view file, PlyHeader const &header, Mesh &out_mesh) {
+    const bool b_swap = (header.format == PlyFormat::binary_big_endian) != (std::endian::native == std::endian::big);
+
+    const char *cursor = file.data() + header.body_offset;
+    const char *const file_end = file.data() + file.size();
+    bool b_has_vertices = false;
+    bool b_has_faces = false;
+
+    for (PlyElement const &element : header.elements) {
+        if (element.name == "vertex") {
+            const std::size_t stride = element.fixedStride();
+            const auto layout = find_ply_vertex_layout(element);
+            if (stride == 0 || !layout || element.count > (std::size_t) (file_end - cursor) / stride) return false;
+
+            out_mesh.vertices.resize(element.count);
+            parallel_for_blocks(element.count, [&, cursor](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    const char *record = cursor + i * stride;
+                    out_mesh.vertices[i] = {
+                        load_ply_scalar<float>(record + layout->byte_offsets[0], layout->types[0], b_swap),
+                        load_ply_scalar<float>(record + layout->byte_offsets[1], layout->types[1], b_swap),
+                        load_ply_scalar<float>(record + layout->byte_offsets[2], layout->types[2], b_swap),
+                    };
+                }
+            });
+
+            cursor += element.count * stride;
+            b_has_vertices = true;
+        } else if (element.name == "face") {
+            const auto list_index = find_ply_face_list(element);
+            if (!list_index) return false;
+
+            PlyProperty const &list = element.properties[*list_index];
+            const std::size_t count_size = ply_type_size(list.count_type);
+            const std::size_t index_size = ply_type_size(list.type);
+
+            std::size_t prefix_size = 0, suffix_size = 0;
+            for (std::size_t i = 0; i < element.properties.size(); ++i) {
+                if (i < *list_index) prefix_size += ply_type_size(element.properties[i].type);
+                if (i > *list_index) suffix_size += ply_type_size(element.properties[i].type);
+            }
+
+            // fixed-size records as long as every face is a triangle, which makes them addressable in parallel
+            const std::size_t triangle_stride = prefix_size + count_size + 3 * index_size + suffix_size;
+            std::atomic<bool> b_all_triangles = element.count <= (std::size_t) (file_end - cursor) / triangle_stride;
+
+            if (b_all_triangles) {
+                parallel_for_blocks(element.count, [&, cursor](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end && b_all_triangles.load(std::memory_order_relaxed); ++i) {
+                        const char *record = cursor + i * triangle_stride + prefix_size;
+                        if (load_ply_scalar<std::uint32_t>(record, list.count_type, b_swap) != 3) b_all_triangles = false;
+                    }
+                });
+            }
+
+            if (b_all_triangles) {
+                out_mesh.indices.resize(element.count);
+                parallel_for_blocks(element.count, [&, cursor](std::size_t begin, std::size_t end) {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        const char *indices = cursor + i * triangle_stride + prefix_size + count_size;
+                        out_mesh.indices[i] = {
+                            load_ply_scalar<glm::uint32>(indices, list.type, b_swap),
+                            load_ply_scalar<glm::uint32>(indices + index_size, list.type, b_swap),
+                            load_ply_scalar<glm::uint32>(indices + 2 * index_size, list.type, b_swap),
+                        };
+                    }
+                });
+                cursor += element.count * triangle_stride;
+            } else {
+                // polygons, records must be walked in order and fan-triangulated
+                out_mesh.indices.clear();
+                out_mesh.indices.reserve(element.count);
+                for (std::size_t i = 0; i < element.count; ++i) {
+                    if ((std::size_t) (file_end - cursor) < prefix_size + count_size) return false;
+                    const auto num_corners = load_ply_scalar<std::size_t>(cursor + prefix_size, list.count_type, b_swap);
+                    const char *indices = cursor + prefix_size + count_size;
+                    const std::size_t record_size = prefix_size + count_size + num_corners * index_size + suffix_size;
+                    if ((std::size_t) (file_end - cursor) < record_size) return false;
+
+                    cursor += record_size;
+                    if (num_corners < 3) continue; // no triangle, and maybe no first corner to read
+
+                    const auto first_corner = load_ply_scalar<glm::uint32>(indices, list.type, b_swap);
+                    for (std::size_t corner = 1; corner + 1 < num_corners; ++corner) {
+                        const char *edge = indices + corner * index_size;
+                        out_mesh.indices.emplace_back(first_corner, load_ply_scalar<glm::uint32>(edge, list.type, b_swap),
+                                                      load_ply_scalar<glm::uint32>(edge + index_size, list.type, b_swap));
+                    }
+                }
+            }
+
+            b_has_faces = true;
+        } else {
+            if (b_has_vertices && b_has_faces) break; // trailing elements are not needed
+
+            const std::size_t stride = element.fixedStride();
+            if (stride == 0 || element.count > (std::size_t) (file_end - cursor) / stride) return false;
+            cursor += element.count * stride;
+        }
+    }
+
+    return b_has_vertices && b_has_faces;
+}
+
+bool read_ascii_ply(std::string_view file, PlyHeader const &header, Mesh &out_mesh) {
+    // one line per element instance, so every element owns a known range of lines
+    std::size_t vertex_first_line = 0, face_first_line = 0, num_header_lines = 0;
+    PlyElement const *vertex_element = nullptr;
+    PlyElement const *face_element = nullptr;
+
+    // a line takes at least a byte, counts beyond that are corrupt and would only size huge buffers
+    const std::string_view body = file.substr(header.body_offset);
+    for (PlyElement const &element : header.elements) {
+        if (element.count > body.size() - num_header_lines) return false;
+
+        if (element.name == "vertex") {
+            vertex_element = &element;
+            vertex_first_line = num_header_lines;
+        } else if (element.name == "face") {
+            face_element = &element;
+            face_first_line = num_header_lines;
+        }
+        num_header_lines += element.count;
+    }
+
+    if (!vertex_element || !face_element) return false;
+
+    const auto layout = find_ply_vertex_layout(*vertex_element);
+    const auto list_index = find_ply_face_list(*face_element);
+    if (!layout || !list_index) return false;
+
+    const std::vector<std::string_view> chunks = split_in_line_chunks(body);
+
+    std::vector<std::size_t> chunk_first_lines(chunks.size() + 1, 0);
+    std::vector<std::size_t> chunk_indices(chunks.size());
+    std::iota(chunk_indices.begin(), chunk_indices.end(), 0);
+    std::transform(std::execution::par, chunks.begin(), chunks.end(), chunk_first_lines.begin() + 1, count_lines);
+    std::inclusive_scan(chunk_first_lines.begin(), chunk_first_lines.end(), chunk_first_lines.begin());
+    if (chunk_first_lines.back() < num_header_lines) return false; // truncated
+
+    out_mesh.vertices.resize(vertex_element->count);
+    std::vector<std::vector<glm::uvec3>> chunk_triangles(chunks.size());
+    std::atomic<bool> b_failed = false;
+
+    std::for_each(std::execution::par, chunk_indices.begin(), chunk_indices.end(), [&](std::size_t chunk_index) {
+        std::size_t line_index = chunk_first_lines[chunk_index];
+        std::vector<glm::uint32> corners;
+
+        for_each_line(chunks[chunk_index], [&](std::string_view line) {
+            if (line_index - vertex_first_line < vertex_element->count) {
+                float values[3] = {};
+                for (std::size_t property_index = 0; property_index < vertex_element->properties.size(); ++property_index) {
+                    const std::string_view token = next_token(line);
+                    for (std::size_t axis = 0; axis < 3; ++axis) {
+                        if (layout->property_indices[axis] == property_index && !parse_number(token, values[axis])) b_failed = true;
+                    }
+                }
+                out_mesh.vertices[line_index - vertex_first_line] = {values[0], values[1], values[2]};
+            } else if (line_index - face_first_line < face_element->count) {
+                for (std::size_t property_index = 0; property_index < *list_index; ++property_index) next_token(line);
+
+                // every corner takes a token and a separator, so what is left of the line bounds the count
+                std::size_t num_corners = 0;
+                if (!parse_number(next_token(line), num_corners) || num_corners > (line.size() + 1) / 2) {
+                    b_failed = true;
+                    num_corners = 0;
+                }
+
+                corners.resize(num_corners);
+                for (auto &corner : corners) {
+                    if (!parse_number(next_token(line), corner)) b_failed = true;
+                }
+                for (std::size_t corner = 1; corner + 1 < num_corners; ++corner) {
+                    chunk_triangles[chunk_index].emplace_back(corners[0], corners[corner], corners[corner + 1]);
+                }
+            }
+            ++line_index;
+        });
+    });
+
+    if (b_failed) return false;
+
+    concatenate_triangles(chunk_triangles, out_mesh.indices);
+    return true;
+}
+
+// ---------- OBJ -----------
+
+/// both passes of parse_obj decide with this, so the vertices read never outnumber those counted
+bool is_obj_vertex_keyword(std::string_view keyword) { return keyword == "v"; }
+
+bool is_obj_vertex_line(std::string_view line) { return is_obj_vertex_keyword(next_token(line)); }
+
+} // namespace
+
+bool read_ply(const char *file_path, Mesh &out_mesh) {
+    const MappedFile mapped_file{file_path};
+    return mapped_file.isValid() && parse_ply(mapped_file.view(), out_mesh);
+}
+
+bool read_obj(const char *file_path, Mesh &out_mesh) {
+    const MappedFile mapped_file{file_path};
+    return mapped_file.isValid() && parse_obj(mapped_file.view(), out_mesh);
+}
+
+bool parse_ply(std::string_view file_data, Mesh &out_mesh) {
+    const auto header = parse_ply_header(file_data);
+    if (!header) return false;
+
+    Mesh mesh;
+    const bool b_success = header->format == PlyFormat::ascii ? read_ascii_ply(file_data, *header, mesh)
+                                                              : read_binary_ply(file_data, *header, mesh);
+    if (!b_success || !has_valid_indices(mesh)) return false;
+
+    out_mesh = std::move(mesh);
+    return true;
+}
+
+bool parse_obj(std::string_view file_data, Mesh &out_mesh) {
+    const std::vector<std::string_view> chunks = split_in_line_chunks(file_data);
+    std::vector<std::size_t> chunk_indices(chunks.size());
+    std::iota(chunk_indices.begin(), chunk_indices.end(), 0);
+
+    // vertices before each chunk, relative (negative) face indices count back from there
+    std::vector<std::size_t> chunk_vertex_offsets(chunks.size() + 1, 0);
+    std::transform(std::execution::par, chunks.begin(), chunks.end(), chunk_vertex_offsets.begin() + 1, [](std::string_view chunk) {
+        std::size_t num_vertices = 0;
+        for_each_line(chunk, [&num_vertices](std::string_view line) { num_vertices += is_obj_vertex_line(line); });
+        return num_vertices;
+    });
+    std::inclusive_scan(chunk_vertex_offsets.begin(), chunk_vertex_offsets.end(), chunk_vertex_offsets.begin());
+
+    Mesh mesh;
+    mesh.vertices.resize(chunk_vertex_offsets.back());
+    std::vector<std::vector<glm::uvec3>> chunk_triangles(chunks.size());
+    std::atomic<bool> b_failed = false;
+
+    std::for_each(std::execution::par, chunk_indices.begin(), chunk_indices.end(), [&](std::size_t chunk_index) {
+        std::size_t num_vertices = chunk_vertex_offsets[chunk_index];
+        std::vector<glm::uint32> corners;
+
+        for_each_line(chunks[chunk_index], [&](std::string_view line) {
+            const std::string_view keyword = next_token(line);
+
+            if (is_obj_vertex_keyword(keyword)) {
+                if (num_vertices == chunk_vertex_offsets[chunk_index + 1]) {
+                    b_failed = true;
+                    return;
+                }
+                glm::vec3 &vertex = mesh.vertices[num_vertices++];
+                if (!parse_number(next_token(line), vertex.x) || !parse_number(next_token(line), vertex.y) ||
+                    !parse_number(next_token(line), vertex.z)) {
+                    b_failed = true;
+                }
+            } else if (keyword == "f") {
+                corners.clear();
+                for (std::string_view token = next_token(line); !token.empty(); token = next_token(line)) {
+                    std::int64_t index = 0;
+                    if (!parse_number(token.substr(0, token.find('/')), index) || index == 0) {
+                        b_failed = true;
+                        return;
+                    }
+                    // 1-based, negative ones are relative to the last vertex so far
+                    corners.push_back(glm::uint32(index > 0 ? index - 1 : (std::int64_t) num_vertices + index));
+                }
+                for (std::size_t corner = 1; corner + 1 < corners.size(); ++corner) {
+                    chunk_triangles[chunk_index].emplace_back(corners[0], corners[corner], corners[corner + 1]);
+                }
+            }
+            // normals, texture coordinates, groups and materials are not needed
+        });
+    });
+
+    if (b_failed) return false;
+
+    concatenate_triangles(chunk_triangles, mesh.indices);
+    if (mesh.indices.empty() || !has_valid_indices(mesh)) return false;
+
+    out_mesh = std::move(mesh);
+    return true;
+}
@@ -0,0 +1,330 @@
+#include "mesh.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <execution>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+#include <glm/geometric.hpp>
+
+namespace {
+
+/// sum of squared distances to a set of planes, the 10 distinct coefficients of the symmetric 4x4 matrix
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+    /// plane n.x + d = 0 with a unit normal
+    static Quadric fromPlane(glm::dvec3 n, double d) {
+        return {n.x * n.x, n.x * n.y, n.x * n.z, n.x * d, n.y * n.y, n.y * n.z, n.y * d, n.z * n.z, n.z * d, d * d};
+    }
+
+    Quadric &operator+=(Quadric const &rhs) {
+        a2 += rhs.a2, ab += rhs.ab, ac += rhs.ac, ad += rhs.ad, b2 += rhs.b2;
+        bc += rhs.bc, bd += rhs.bd, c2 += rhs.c2, cd += rhs.cd, d2 += rhs.d2;
+        return *this;
+    }
+
+    [[nodiscard]] double evaluate(glm::dvec3 p) const {
+        return a2 * p.x * p.x + 2 * ab * p.x * p.y + 2 * ac * p.x * p.z + 2 * ad * p.x + b2 * p.y * p.y + 2 * bc * p.y * p.z +
+               2 * bd * p.y + c2 * p.z * p.z + 2 * cd * p.z + d2;
+    }
+
+    /// point of least error, false when the planes do not pin one down (flat or cylindrical neighbourhoods)
+    [[nodiscard]] bool minimize(glm::dvec3 &out_point) const {
+        // Cramer's rule on the symmetric system A p = -b
+        const glm::dvec3 row0{a2, ab, ac}, row1{ab, b2, bc}, row2{ac, bc, c2}, b{ad, bd, cd};
+        const double det = glm::dot(row0, glm::cross(row1, row2));
+        const double scale = a2 * b2 * c2; // determinant of the diagonal, relative threshold against near-singular systems
+        if (std::abs(det) <= 1e-8 * std::max(scale, 1e-30)) return false;
+
+        out_point = -glm::dvec3{glm::dot(b, glm::cross(row1, row2)), glm::dot(row0, glm::cross(b, row2)),
+                                glm::dot(row0, glm::cross(row1, b))} / det;
+        return true;
+    }
+};
+
+/// candidate collapse in the queue, outdated once either vertex moved since (versions are per vertex and only grow)
+struct CollapseCandidate {
+    float cost;
+    glm::uint32 v0, v1;
+    glm::uint32 version_sum;
+
+    bool operator>(CollapseCandidate const &rhs) const { return cost > rhs.cost; }
+};
+
+class QuadricSimplifier {
+public:
+    explicit QuadricSimplifier(Mesh const &mesh);
+
+    /// collapses edges while the cheapest one stays within `max_error`
+    void collapse(float max_error);
+
+    /// remaining triangles, vertices in order of first use
+    [[nodiscard]] Mesh extract() const;
+
+private:
+    void pushCandidate(glm::uint32 v0, glm::uint32 v1);
+    [[nodiscard]] glm::dvec3 findTarget(glm::uint32 v0, glm::uint32 v1, Quadric const &quadric) const;
+    [[nodiscard]] bool isValidCollapse(glm::uint32 v0, glm::uint32 v1, glm::vec3 target) const;
+    void collectNeighbours(glm::uint32 vertex, std::vector<glm::uint32> &out_neighbours) const;
+
+    std::vector<glm::vec3> positions_;
+    std::vector<glm::uvec3> triangles_;
+    std::vector<bool> b_removed_triangle_;
+    std::vector<bool> b_removed_vertex_;
+    std::vector<bool> b_locked_vertex_; // on non-manifold edges
+    std::vector<std::vector<glm::uint32>> vertex_triangles_;
+    std::vector<Quadric> quadrics_;
+    std::vector<glm::uint32> versions_;
+    std::priority_queue<CollapseCandidate, std::vector<CollapseCandidate>, std::greater<>> candidates_;
+};
+
+QuadricSimplifier::QuadricSimplifier(Mesh const &mesh) {
+    // weld equal positions, importers split vertices on seams which would otherwise become borders
+    std::vector<glm::uint32> sorted_vertices(mesh.vertices.size());
+    std::iota(sorted_vertices.begin(), sorted_vertices.end(), 0);
+    const auto position_key = [&](glm::uint32 vertex) {
+        return std::tuple{mesh.vertices[vertex].x, mesh.vertices[vertex].y, mesh.vertices[vertex].z};
+    };
+    std::sort(std::execution::par_unseq, sorted_vertices.begin(), sorted_vertices.end(),
+              [&](glm::uint32 lhs, glm::uint32 rhs) { return position_key(lhs) < position_key(rhs); });
+
+    std::vector<glm::uint32> weld_remap(mesh.vertices.size());
+    for (std::size_t i = 0; i < sorted_vertices.size(); ++i) {
+        if (i == 0 || position_key(sorted_vertices[i]) != position_key(sorted_vertices[i - 1])) {
+            positions_.push_back(mesh.vertices[sorted_vertices[i]]);
+        }
+        weld_remap[sorted_vertices[i]] = glm::uint32(positions_.size() - 1);
+    }
+
+    triangles_.reserve(mesh.indices.size());
+    for (glm::uvec3 triangle : mesh.indices) {
+        triangle = {weld_remap[triangle.x], weld_remap[triangle.y], weld_remap[triangle.z]};
+        if (triangle.x != triangle.y && triangle.y != triangle.z && triangle.z != triangle.x) triangles_.push_back(triangle);
+    }
+
+    const std::size_t num_vertices = positions_.size();
+    b_removed_triangle_.assign(triangles_.size(), false);
+    b_removed_vertex_.assign(num_vertices, false);
+    b_locked_vertex_.assign(num_vertices, false);
+    vertex_triangles_.resize(num_vertices);
+    quadrics_.resize(num_vertices);
+    versions_.assign(num_vertices, 0);
+
+    // one plane per triangle, not weighted by area so the error stays a distance
+    for (glm::uint32 triangle_index = 0; triangle_index < triangles_.size(); ++triangle_index) {
+        const glm::uvec3 triangle = triangles_[triangle_index];
+        const glm::dvec3 A = positions_[triangle.x], B = positions_[triangle.y], C = positions_[triangle.z];
+        const glm::dvec3 normal = glm::cross(B - A, C - A);
+        const double normal_length = glm::length(normal);
+
+        for (glm::uint32 k = 0; k < 3; ++k) vertex_triangles_[triangle[k]].push_back(triangle_index);
+        if (normal_length == 0) continue;
+
+        const Quadric plane = Quadric::fromPlane(normal / normal_length, -glm::dot(normal / normal_length, A));
+        for (glm::uint32 k = 0; k < 3; ++k) quadrics_[triangle[k]] += plane;
+    }
+
+    // edges with the triangles using them, borders get a plane across them so they cannot drift away either
+    std::vector<std::tuple<glm::uint32, glm::uint32, glm::uint32>> edges;
+    edges.reserve(triangles_.size() * 3);
+    for (glm::uint32 triangle_index = 0; triangle_index < triangles_.size(); ++triangle_index) {
+        const glm::uvec3 triangle = triangles_[triangle_index];
+        for (glm::uint32 k = 0; k < 3; ++k) {
+            const glm::uint32 start = triangle[k], end = triangle[(k + 1) % 3];
+            edges.emplace_back(std::min(start, end), std::max(start, end), triangle_index);
+        }
+    }
+    std::sort(std::execution::par_unseq, edges.begin(), edges.end());
+
+    for (std::size_t i = 0; i < edges.size();) {
+        const auto [v0, v1, first_triangle] = edges[i];
+        std::size_t j = i + 1;
+        while (j < edges.size() && std::get<0>(edges[j]) == v0 && std::get<1>(edges[j]) == v1) ++j;
+
+        if (j - i == 1) {
+            const glm::uvec3 triangle = triangles_[first_triangle];
+            const glm::dvec3 A = positions_[triangle.x], B = positions_[triangle.y], C = positions_[triangle.z];
+            const glm::dvec3 edge_start = positions_[v0], edge_end = positions_[v1];
+            const glm::dvec3 border_normal = glm::cross(edge_end - edge_start, glm::cross(B - A, C - A));
+            const double border_normal_length = glm::length(border_normal);
+            if (border_normal_length > 0) {
+                const glm::dvec3 n = border_normal / border_normal_length;
+                const Quadric border_plane = Quadric::fromPlane(n, -glm::dot(n, edge_start));
+                quadrics_[v0] += border_plane;
+                quadrics_[v1] += border_plane;
+            }
+        } else if (j - i > 2) {
+            b_locked_vertex_[v0] = b_locked_vertex_[v1] = true;
+        }
+        i = j;
+    }
+
+    // once every non-manifold edge has locked its vertices, edges sorted before it would be queued with them otherwise
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        const glm::uint32 v0 = std::get<0>(edges[i]), v1 = std::get<1>(edges[i]);
+        if (i > 0 && std::get<0>(edges[i - 1]) == v0 && std::get<1>(edges[i - 1]) == v1) continue;
+        pushCandidate(v0, v1);
+    }
+}
+
+glm::dvec3 QuadricSimplifier::findTarget(glm::uint32 v0, glm::uint32 v1, Quadric const &quadric) const {
+    const glm::dvec3 start = positions_[v0], end = positions_[v1];
+
+    // the optimum may lie far off for almost flat neighbourhoods, only keep it near the edge
+    glm::dvec3 optimum;
+    if (quadric.minimize(optimum) && glm::distance(optimum, 0.5 * (start + end)) <= glm::distance(start, end)) return optimum;
+
+    glm::dvec3 best = start;
+    for (glm::dvec3 candidate : {end, 0.5 * (start + end)}) {
+        if (quadric.evaluate(candidate) < quadric.evaluate(best)) best = candidate;
+    }
+    return best;
+}
+
+void QuadricSimplifier::pushCandidate(glm::uint32 v0, glm::uint32 v1) {
+    if (b_locked_vertex_[v0] || b_locked_vertex_[v1]) return;
+
+    Quadric quadric = quadrics_[v0];
+    quadric += quadrics_[v1];
+    const double cost = std::max(quadric.evaluate(findTarget(v0, v1, quadric)), 0.0);
+    candidates_.push({float(cost), v0, v1, versions_[v0] + versions_[v1]});
+}
+
+void QuadricSimplifier::collectNeighbours(glm::uint32 vertex, std::vector<glm::uint32> &out_neighbours) const {
+    out_neighbours.clear();
+    for (glm::uint32 triangle_index : vertex_triangles_[vertex]) {
+        for (glm::uint32 k = 0; k < 3; ++k) {
+            if (triangles_[triangle_index][k] != vertex) out_neighbours.push_back(triangles_[triangle_index][k]);
+        }
+    }
+    std::sort(out_neighbours.begin(), out_neighbours.end());
+    out_neighbours.erase(std::unique(out_neighbours.begin(), out_neighbours.end()), out_neighbours.end());
+}
+
+bool QuadricSimplifier::isValidCollapse(glm::uint32 v0, glm::uint32 v1, glm::vec3 target) const {
+    // link condition, the edge's triangles must be the only ones both vertices share a neighbour through
+    static thread_local std::vector<glm::uint32> neighbours0, neighbours1, common_neighbours;
+    collectNeighbours(v0, neighbours0);
+    collectNeighbours(v1, neighbours1);
+    common_neighbours.clear();
+    std::set_intersection(neighbours0.begin(), neighbours0.end(), neighbours1.begin(), neighbours1.end(),
+                          std::back_inserter(common_neighbours));
+
+    glm::uint32 num_edge_triangles = 0;
+    for (glm::uint32 triangle_index : vertex_triangles_[v0]) {
+        const glm::uvec3 triangle = triangles_[triangle_index];
+        num_edge_triangles += triangle.x == v1 || triangle.y == v1 || triangle.z == v1;
+    }
+    if (common_neighbours.size() != num_edge_triangles) return false;
+
+    // no triangle may flip or collapse to a sliver
+    for (glm::uint32 vertex : {v0, v1}) {
+        for (glm::uint32 triangle_index : vertex_triangles_[vertex]) {
+            const glm::uvec3 triangle = triangles_[triangle_index];
+            if ((triangle.x == v0 || triangle.y == v0 || triangle.z == v0) && (triangle.x == v1 || triangle.y == v1 || triangle.z == v1)) {
+                continue; // removed by the collapse
+            }
+
+            std::array<glm::vec3, 3> corners{positions_[triangle.x], positions_[triangle.y], positions_[triangle.z]};
+            const glm::vec3 old_normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+            for (glm::uint32 k = 0; k < 3; ++k) {
+                if (triangle[k] == vertex) corners[k] = target;
+            }
+            const glm::vec3 new_normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+
+            const float old_length = glm::length(old_normal), new_length = glm::length(new_normal);
+            if (new_length <= 1e-6f * old_length || glm::dot(old_normal, new_normal) < 0.2f * old_length * new_length) return false;
+        }
+    }
+
+    return true;
+}
+
+void QuadricSimplifier::collapse(float max_error) {
+    const double max_cost = double(max_error) * max_error;
+    std::vector<glm::uint32> neighbours;
+
+    while (!candidates_.empty() && candidates_.top().cost <= max_cost) {
+        const CollapseCandidate candidate = candidates_.top();
+        candidates_.pop();
+
+        const glm::uint32 v0 = candidate.v0, v1 = candidate.v1;
+        if (b_removed_vertex_[v0] || b_removed_vertex_[v1] || candidate.version_sum != versions_[v0] + versions_[v1]) continue;
+
+        Quadric quadric = quadrics_[v0];
+        quadric += quadrics_[v1];
+        const glm::vec3 target = findTarget(v0, v1, quadric);
+        if (!isValidCollapse(v0, v1, target)) continue; // may become valid once a neighbour moves and pushes it again
+
+        // v1 merges into v0
+        positions_[v0] = target;
+        quadrics_[v0] = quadric;
+        b_removed_vertex_[v1] = true;
+        ++versions_[v0];
+
+        for (glm::uint32 triangle_index : vertex_triangles_[v1]) {
+            glm::uvec3 &triangle = triangles_[triangle_index];
+            if (triangle.x == v0 || triangle.y == v0 || triangle.z == v0) {
+                b_removed_triangle_[triangle_index] = true;
+                continue;
+            }
+            for (glm::uint32 k = 0; k < 3; ++k) {
+                if (triangle[k] == v1) triangle[k] = v0;
+            }
+            vertex_triangles_[v0].push_back(triangle_index);
+        }
+        std::vector<glm::uint32>{}.swap(vertex_triangles_[v1]);
+
+        // the removed triangles also leave the lists of the third vertices
+        collectNeighbours(v0, neighbours);
+        for (glm::uint32 vertex : neighbours) {
+            std::erase_if(vertex_triangles_[vertex], [this](glm::uint32 triangle_index) { return b_removed_triangle_[triangle_index]; });
+        }
+        std::erase_if(vertex_triangles_[v0], [this](glm::uint32 triangle_index) { return b_removed_triangle_[triangle_index]; });
+
+        collectNeighbours(v0, neighbours);
+        for (glm::uint32 vertex : neighbours) pushCandidate(v0, vertex);
+    }
+}
+
+Mesh QuadricSimplifier::extract() const {
+    constexpr glm::uint32 unmapped_vertex = std::numeric_limits<glm::uint32>::max();
+    std::vector<glm::uint32> vertex_remap(positions_.size(), unmapped_vertex);
+
+    Mesh result;
+    for (glm::uint32 triangle_index = 0; triangle_index < triangles_.size(); ++triangle_index) {
+        if (b_removed_triangle_[triangle_index]) continue;
+
+        glm::uvec3 triangle = triangles_[triangle_index];
+        for (glm::uint32 k = 0; k < 3; ++k) {
+            glm::uint32 &remapped_index = vertex_remap[triangle[k]];
+            if (remapped_index == unmapped_vertex) {
+                remapped_index = result.vertices.size();
+                result.vertices.push_back(positions_[triangle[k]]);
+            }
+            triangle[k] = remapped_index;
+        }
+        result.indices.push_back(triangle);
+    }
+    return result;
+}
+
+} // namespace
+
+std::vector<Mesh> Mesh::simplify(std::span<const float> max_errors) const {
+    QuadricSimplifier simplifier{*this};
+
+    std::vector<Mesh> lods;
+    lods.reserve(max_errors.size());
+    for (float max_error : max_errors) {
+        simplifier.collapse(max_error);
+        lods.push_back(simplifier.extract());
+    }
+    return lods;
+}
@@ -0,0 +1,164 @@
+#include "numa_topology.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <sched.h>
+#include <string>
+#endif
+
+namespace {
+
+/// CPUs the process may run on, in increasing order
+std::vector<glm::uint32> get_allowed_cpus() {
+    std::vector<glm::uint32> cpus;
+#ifdef _WIN32
+    DWORD_PTR process_mask = 0, system_mask = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+        for (glm::uint32 cpu = 0; cpu < sizeof(DWORD_PTR) * 8; ++cpu) {
+            if (process_mask >> cpu & 1) cpus.push_back(cpu);
+        }
+    }
+#elif defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+        for (glm::uint32 cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &cpu_set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        for (glm::uint32 cpu = 0; cpu < std::max(std::thread::hardware_concurrency(), 1u); ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+#ifdef __linux__
+/// "0-3,8-11" as in /sys/devices/system/node/node<N>/cpulist
+std::vector<glm::uint32> parse_cpu_list(std::string const &cpu_list) {
+    std::vector<glm::uint32> cpus;
+    std::size_t begin = 0;
+    while (begin < cpu_list.size()) {
+        const std::size_t end = std::min(cpu_list.find(',', begin), cpu_list.size());
+        const std::string range = cpu_list.substr(begin, end - begin);
+        const std::size_t dash = range.find('-');
+        const glm::uint32 first = glm::uint32(std::stoul(range.substr(0, dash)));
+        const glm::uint32 last = dash == std::string::npos ? first : glm::uint32(std::stoul(range.substr(dash + 1)));
+        for (glm::uint32 cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        begin = end + 1;
+    }
+    return cpus;
+}
+#endif
+
+} // namespace
+
+NumaTopology NumaTopology::detect() {
+    const std::vector<glm::uint32> allowed_cpus = get_allowed_cpus();
+    const auto is_allowed = [&allowed_cpus](glm::uint32 cpu) { return std::ranges::binary_search(allowed_cpus, cpu); };
+
+    NumaTopology topology;
+#ifdef _WIN32
+    ULONG highest_node = 0;
+    if (GetNumaHighestNodeNumber(&highest_node)) {
+        for (ULONG node = 0; node <= highest_node; ++node) {
+            ULONGLONG node_mask = 0; // processor group 0 only
+            if (!GetNumaNodeProcessorMask(UCHAR(node), &node_mask)) continue;
+
+            std::vector<glm::uint32> cpus;
+            for (glm::uint32 cpu = 0; cpu < 64; ++cpu) {
+                if ((node_mask >> cpu & 1) && is_allowed(cpu)) cpus.push_back(cpu);
+            }
+            if (!cpus.empty()) topology.node_cpus.push_back(std::move(cpus));
+        }
+    }
+#elif defined(__linux__)
+    for (glm::uint32 node = 0;; ++node) {
+        std::ifstream fin{"/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"};
+        std::string cpu_list;
+        if (!fin || !std::getline(fin, cpu_list)) break;
+
+        std::vector<glm::uint32> cpus = parse_cpu_list(cpu_list);
+        std::erase_if(cpus, [&](glm::uint32 cpu) { return !is_allowed(cpu); });
+        if (!cpus.empty()) topology.node_cpus.push_back(std::move(cpus));
+    }
+#endif
+    if (topology.node_cpus.empty()) topology.node_cpus.push_back(allowed_cpus);
+    return topology;
+}
+
+NumaTopology NumaTopology::simulate(glm::uint32 num_nodes) {
+    const std::vector<glm::uint32> allowed_cpus = get_allowed_cpus();
+    num_nodes = std::max(num_nodes, 1u);
+
+    NumaTopology topology;
+    topology.node_cpus.resize(num_nodes);
+    const std::size_t num_cpus = allowed_cpus.size();
+    if (num_cpus < num_nodes) {
+        for (glm::uint32 node = 0; node < num_nodes; ++node) topology.node_cpus[node].push_back(allowed_cpus[node % num_cpus]);
+        return topology;
+    }
+    for (std::size_t i = 0; i < num_cpus; ++i) topology.node_cpus[i * num_nodes / num_cpus].push_back(allowed_cpus[i]);
+    return topology;
+}
+
+bool pin_current_thread(std::span<const glm::uint32> cpus) {
+#ifdef _WIN32
+    DWORD_PTR thread_mask = 0;
+    for (glm::uint32 cpu : cpus) {
+        if (cpu < sizeof(DWORD_PTR) * 8) thread_mask |= DWORD_PTR(1) << cpu;
+    }
+    return thread_mask != 0 && SetThreadAffinityMask(GetCurrentThread(), thread_mask) != 0;
+#elif defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (glm::uint32 cpu : cpus) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &cpu_set);
+    }
+    return CPU_COUNT(&cpu_set) > 0 && sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0; // 0 is the calling thread
+#else
+    (void) cpus;
+    return false;
+#endif
+}
+
+void run_pinned_per_node(NumaTopology const &topology, std::span<const std::size_t> num_node_items,
+                         std::function<void(glm::uint32 node, std::size_t item)> const &work) {
+    const glm::uint32 num_nodes = topology.getNumNodes();
+    const auto next_items = std::make_unique<std::atomic<std::size_t>[]>(num_nodes);
+
+    std::vector<std::thread> threads;
+    for (glm::uint32 node = 0; node < num_nodes; ++node) {
+        for (std::size_t i = 0; i < topology.node_cpus[node].size(); ++i) {
+            threads.emplace_back([&, node] {
+                pin_current_thread(topology.node_cpus[node]);
+
+                // own node first, its data is local, then the others in turn so no CPU idles on an unbalanced split
+                for (glm::uint32 offset = 0; offset < num_nodes; ++offset) {
+                    const glm::uint32 item_node = (node + offset) % num_nodes;
+                    std::size_t item;
+                    while ((item = next_items[item_node].fetch_add(1, std::memory_order_relaxed)) < num_node_items[item_node]) {
+                        work(item_node, item);
+                    }
+                }
+            });
+        }
+    }
+    for (auto &thread : threads) thread.join();
+}
+
+void run_pinned_on_node(NumaTopology const &topology, glm::uint32 node, std::function<void()> const &work) {
+    std::thread{[&] {
+        pin_current_thread(topology.node_cpus[node]);
+        work();
+    }}.join();
+}
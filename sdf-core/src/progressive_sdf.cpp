@@ -0,0 +1,42 @@
+#include "progressive_sdf.h"
+
+ProgressiveDistanceFieldBake::ProgressiveDistanceFieldBake(Mesh const &mesh, Box bounds, float distance_field_resolution_scale,
+                                                           bool b_generate_as_if_two_sided, BakeSettings const &settings,
+                                                           std::chrono::steady_clock::duration time_budget,
+                                                           MipCompleteCallback on_mip_complete)
+    : ProgressiveDistanceFieldBake{std::span<const MeshInstance>{std::array{MeshInstance{&mesh}}}, bounds, distance_field_resolution_scale,
+                                   b_generate_as_if_two_sided, settings, time_budget, std::move(on_mip_complete)} {}
+
+ProgressiveDistanceFieldBake::ProgressiveDistanceFieldBake(std::span<const MeshInstance> instances, Box bounds,
+                                                           float distance_field_resolution_scale, bool b_generate_as_if_two_sided,
+                                                           BakeSettings const &settings, std::chrono::steady_clock::duration time_budget,
+                                                           MipCompleteCallback on_mip_complete)
+    : instances_{instances.begin(), instances.end()}, settings_{settings} {
+    control_.deadline = std::chrono::steady_clock::now() + time_budget;
+    control_.on_mip_complete = std::move(on_mip_complete);
+
+    worker_ = std::thread{[this, bounds, distance_field_resolution_scale, b_generate_as_if_two_sided] {
+        generate_distance_field_volume_data(instances_, bounds, distance_field_resolution_scale, b_generate_as_if_two_sided, settings_,
+                                            result_, &control_);
+        b_finished_ = true;
+    }};
+}
+
+ProgressiveDistanceFieldBake::~ProgressiveDistanceFieldBake() {
+    cancel();
+    if (worker_.joinable()) worker_.join();
+}
+
+float ProgressiveDistanceFieldBake::getProgress() const {
+    const std::size_t num_total_bricks = control_.num_total_bricks;
+    if (num_total_bricks == 0) return 0.0f;
+    return float(control_.num_baked_bricks) / float(num_total_bricks);
+}
+
+glm::uint32 ProgressiveDistanceFieldBake::wait(DistanceFieldVolumeData &out_data) {
+    if (worker_.joinable()) worker_.join();
+
+    const glm::uint32 finest_complete_mip = control_.finest_complete_mip;
+    if (finest_complete_mip < DistanceField::NUM_MIPS) out_data = std::move(result_);
+    return finest_complete_mip;
+}
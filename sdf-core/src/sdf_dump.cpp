@@ -0,0 +1,438 @@
+#include "sdf_dump.h"
+
+#include "format.hpp"
+#include "local_sdf.h"
+#include "mapped_file.h"
+#include "mesh.h"
+#include "sdf_sampler.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <execution>
+#include <numeric>
+#include <span>
+#include <string>
+
+namespace {
+
+struct uchar4 { // NOLINT
+    union {
+        struct {
+            glm::uint8 r, g, b, a;
+        };
+        struct {
+            glm::uint8 x, y, z, w;
+        };
+        glm::uint8 data[4];
+    };
+};
+
+struct Vertex {
+    glm::vec3 position;
+    uchar4 color;
+};
+
+template <DistanceField::BrickConfig Config>
+class DistanceFieldDumpTask {
+public:
+    DistanceFieldDumpTask(DistanceFieldMipView const &mip, DistanceFieldMipBrick brick, bool calculate_color)
+        : mip{mip}, brick{brick}, calculate_color{calculate_color}, is_valid{brick.brick_index != DistanceField::INVALID_BRICK_INDEX} {}
+
+    static constexpr glm::uint32 BRICK_SIZE = Config.brick_size;
+    static constexpr glm::uint32 BRICK_VOXELS = Config.getBrickVoxelCount();
+
+    /// colored samples of invalid bricks are not written
+    [[nodiscard]] glm::uint32 numVertices() const { return is_valid || !calculate_color ? BRICK_VOXELS : 0; }
+
+    /// writes `numVertices()` packed vertices to `output`, which needs no alignment
+    void doWork(char *output) const noexcept;
+
+    // inputs, read-only
+    const DistanceFieldMipView mip;
+    const DistanceFieldMipBrick brick;
+    const bool calculate_color;
+    const bool is_valid;
+};
+
+template <DistanceField::BrickConfig Config>
+void DistanceFieldDumpTask<Config>::doWork(char *output) const noexcept {
+    if (numVertices() == 0) return;
+
+    const glm::uint32 brick_index = brick.brick_index;
+    const glm::uint32 brick_size = BRICK_VOXELS;
+    const glm::vec3 sdf_voxel_size = mip.voxel_size / float(1u << brick.level);
+
+    const glm::vec3 indirection_voxel_size = sdf_voxel_size * (float) Config.getUniqueDataBrickSize();
+
+    std::array<Vertex, BRICK_VOXELS> vertices;
+
+    const glm::vec3 brick_min_position = mip.volume_bounds.min + glm::vec3(brick.coordinate) * indirection_voxel_size;
+
+    if (!calculate_color) {
+        const uchar4 display_color = is_valid ? uchar4{200, 200, 200, 255} : uchar4{0, 0, 0, 255};
+        for (glm::uint32 i = 0; i < brick_size; ++i) {
+            const glm::uvec3 voxel_coordinate = {
+                i % BRICK_SIZE,
+                i / BRICK_SIZE % BRICK_SIZE,
+                i / BRICK_SIZE / BRICK_SIZE,
+            };
+            const glm::vec3 sample_position = glm::vec3(voxel_coordinate) * sdf_voxel_size + brick_min_position;
+            vertices[i] = {sample_position, display_color};
+        }
+    } else {
+        for (glm::uint32 i = 0; i < brick_size; ++i) {
+            const glm::uvec3 voxel_coordinate = {
+                i % BRICK_SIZE,
+                i / BRICK_SIZE % BRICK_SIZE,
+                i / BRICK_SIZE / BRICK_SIZE,
+            };
+
+            const glm::vec3 sample_position = glm::vec3(voxel_coordinate) * sdf_voxel_size + brick_min_position;
+            const float distance = 1.0f - mip.getVoxel(brick_index, i);
+            const auto gamma_color = glm::uint8(std::pow(distance, 1.0f / 2.2f) * 255.0f);
+
+            vertices[i] = {sample_position, uchar4{gamma_color, gamma_color, gamma_color, 255}};
+        }
+    }
+
+    std::memcpy(output, vertices.data(), sizeof(vertices));
+}
+
+/// vertices of all tasks in task order, each task writing its own slice of the mapped file in parallel
+template <DistanceField::BrickConfig Config>
+bool dump_vertex(const char *filename, std::span<const DistanceFieldDumpTask<Config>> tasks) {
+    assert(filename != nullptr);
+
+    std::vector<std::size_t> vertex_offsets(tasks.size() + 1, 0);
+    std::transform(tasks.begin(), tasks.end(), vertex_offsets.begin() + 1,
+                   [](DistanceFieldDumpTask<Config> const &task) { return task.numVertices(); });
+    std::inclusive_scan(vertex_offsets.begin(), vertex_offsets.end(), vertex_offsets.begin());
+    const std::size_t vertex_count = vertex_offsets.back();
+
+    // ply header
+    const std::string header = fmt::format("ply\nformat {} 1.0\n"
+                                           "element vertex {}\n"
+                                           "property float x\nproperty float y\nproperty float z\n"
+                                           "property uchar red\nproperty uchar green\nproperty uchar blue\nproperty uchar alpha\n"
+                                           "end_header\n",
+                                           std::endian::native == std::endian::little ? "binary_little_endian" : "binary_big_endian",
+                                           vertex_count);
+
+    MappedOutputFile output_file{filename, header.size() + vertex_count * sizeof(Vertex)};
+    if (!output_file.isValid()) {
+        fmt::print(stderr, "Failed to open {}\n", filename);
+        return false;
+    }
+
+    std::memcpy(output_file.data(), header.data(), header.size());
+    char *const vertex_data = output_file.data() + header.size();
+
+    std::vector<std::size_t> task_indices(tasks.size());
+    std::iota(task_indices.begin(), task_indices.end(), 0);
+    std::for_each(std::execution::par_unseq, task_indices.begin(), task_indices.end(), [&](std::size_t task_index) noexcept {
+        tasks[task_index].doWork(vertex_data + vertex_offsets[task_index] * sizeof(Vertex));
+    });
+
+    return true;
+}
+
+// ---------- iso-surface -----------
+
+/// normalized distance 0, bricks encode distances over [-trace distance, trace distance]
+constexpr float ISO_VALUE = 0.5f;
+
+std::uint64_t get_cell_key(glm::uvec3 global_cell, glm::uvec3 cell_dimensions) {
+    return (std::uint64_t(global_cell.z) * cell_dimensions.y + global_cell.y) * cell_dimensions.x + global_cell.x;
+}
+
+/// naive surface nets on one brick: a vertex per cell crossed by the surface, a quad per crossed lattice edge owned by the brick.
+/// Quads refer to cells by global key at the finest split level, so the ones on brick borders weld to the vertices of neighbour
+/// bricks. Across a split, a coarse cell welds to the fine cell sharing its min corner, which leaves small folds there
+template <DistanceField::BrickConfig Config>
+class IsoSurfaceBrickTask {
+public:
+    static constexpr glm::uint32 BRICK_SIZE = Config.brick_size;
+    /// cells per brick and axis, neighbour bricks share their border sample layer
+    static constexpr glm::uint32 BRICK_CELLS = Config.getUniqueDataBrickSize();
+
+    IsoSurfaceBrickTask(DistanceFieldMipView const &mip, DistanceFieldMipBrick brick, glm::uint32 finest_level)
+        : mip{mip}, brick{brick}, finest_level{finest_level} {}
+
+    void doWork() noexcept;
+
+    // inputs, read-only
+    DistanceFieldMipView const &mip;
+    const DistanceFieldMipBrick brick;
+    const glm::uint32 finest_level;
+
+    // outputs
+    std::vector<std::uint64_t> cell_keys; // one per vertex
+    std::vector<glm::vec3> vertices;
+    std::vector<std::array<std::uint64_t, 4>> quads; // cell keys, counter-clockwise seen from outside
+};
+
+template <DistanceField::BrickConfig Config>
+void IsoSurfaceBrickTask<Config>::doWork() noexcept {
+    // cells of the brick level, keys count them at the finest level
+    const glm::uint32 key_shift = finest_level - brick.level;
+    const glm::uvec3 cell_dimensions = (mip.dimensions * BRICK_CELLS) << finest_level;
+    const glm::uvec3 brick_first_cell = brick.coordinate * BRICK_CELLS;
+    const glm::vec3 cell_size = mip.voxel_size / float(1u << brick.level);
+    const auto cell_key = [&](glm::uvec3 cell) { return get_cell_key(cell << key_shift, cell_dimensions); };
+
+    const glm::uint32 brick_index = brick.brick_index;
+    const auto sample = [&](glm::uvec3 voxel) {
+        return mip.getVoxel(brick_index, (voxel.z * BRICK_SIZE + voxel.y) * BRICK_SIZE + voxel.x);
+    };
+    const auto corner_offset = [](glm::uint32 corner) { return glm::uvec3{corner & 1, corner >> 1 & 1, corner >> 2 & 1}; };
+
+    for (glm::uint32 z_index = 0; z_index < BRICK_CELLS; ++z_index) {
+        for (glm::uint32 y_index = 0; y_index < BRICK_CELLS; ++y_index) {
+            for (glm::uint32 x_index = 0; x_index < BRICK_CELLS; ++x_index) {
+                const glm::uvec3 cell{x_index, y_index, z_index};
+
+                std::array<float, 8> corner_values;
+                glm::uint32 num_inside_corners = 0;
+                for (glm::uint32 corner = 0; corner < 8; ++corner) {
+                    corner_values[corner] = sample(cell + corner_offset(corner));
+                    num_inside_corners += corner_values[corner] < ISO_VALUE;
+                }
+                if (num_inside_corners == 0 || num_inside_corners == 8) continue;
+
+                // vertex at the mean of the edge crossings
+                glm::vec3 crossing_sum{0.0f};
+                glm::uint32 num_crossings = 0;
+                for (glm::uint32 corner = 0; corner < 8; ++corner) {
+                    for (glm::uint32 axis = 0; axis < 3; ++axis) {
+                        const glm::uint32 other_corner = corner | 1u << axis;
+                        if (other_corner == corner) continue;
+
+                        const float start_value = corner_values[corner], end_value = corner_values[other_corner];
+                        if ((start_value < ISO_VALUE) == (end_value < ISO_VALUE)) continue;
+
+                        glm::vec3 crossing{corner_offset(corner)};
+                        crossing[axis] = (ISO_VALUE - start_value) / (end_value - start_value);
+                        crossing_sum += crossing;
+                        ++num_crossings;
+                    }
+                }
+
+                const glm::vec3 local_position = glm::vec3(cell) + crossing_sum / float(num_crossings);
+                vertices.push_back(mip.volume_bounds.min + (glm::vec3(brick_first_cell) + local_position) * cell_size);
+                cell_keys.push_back(cell_key(brick_first_cell + cell));
+            }
+        }
+    }
+
+    // a lattice edge belongs to the brick whose [0, BRICK_CELLS)^3 sample range holds its start
+    for (glm::uint32 z_index = 0; z_index < BRICK_CELLS; ++z_index) {
+        for (glm::uint32 y_index = 0; y_index < BRICK_CELLS; ++y_index) {
+            for (glm::uint32 x_index = 0; x_index < BRICK_CELLS; ++x_index) {
+                const glm::uvec3 edge_start{x_index, y_index, z_index};
+                const bool b_start_inside = sample(edge_start) < ISO_VALUE;
+
+                for (glm::uint32 axis = 0; axis < 3; ++axis) {
+                    glm::uvec3 edge_end = edge_start;
+                    edge_end[axis] += 1;
+                    if (b_start_inside == (sample(edge_end) < ISO_VALUE)) continue;
+
+                    // the four cells around the edge, some may lie in neighbour bricks
+                    const glm::uint32 axis_u = (axis + 1) % 3, axis_v = (axis + 2) % 3;
+                    const glm::uvec3 global_start = brick_first_cell + edge_start;
+                    if (global_start[axis_u] == 0 || global_start[axis_v] == 0) continue; // volume border
+
+                    std::array<glm::uvec3, 4> cells{global_start, global_start, global_start, global_start};
+                    cells[0][axis_u] -= 1;
+                    cells[0][axis_v] -= 1;
+                    cells[1][axis_v] -= 1;
+                    cells[3][axis_u] -= 1;
+
+                    std::array<std::uint64_t, 4> &quad = quads.emplace_back();
+                    for (glm::uint32 k = 0; k < 4; ++k) quad[k] = cell_key(cells[k]);
+                    if (!b_start_inside) std::swap(quad[1], quad[3]); // face the outside
+                }
+            }
+        }
+    }
+}
+
+/// binary PLY with positions and triangles
+bool dump_mesh(const char *filename, Mesh const &mesh) {
+    assert(filename != nullptr);
+
+    const std::string header = fmt::format("ply\nformat {} 1.0\n"
+                                           "element vertex {}\n"
+                                           "property float x\nproperty float y\nproperty float z\n"
+                                           "element face {}\n"
+                                           "property list uchar int vertex_indices\n"
+                                           "end_header\n",
+                                           std::endian::native == std::endian::little ? "binary_little_endian" : "binary_big_endian",
+                                           mesh.vertices.size(), mesh.indices.size());
+
+    constexpr std::size_t vertex_record_size = 3 * sizeof(float);
+    constexpr std::size_t face_record_size = sizeof(glm::uint8) + 3 * sizeof(glm::uint32);
+
+    const std::size_t file_size = header.size() + mesh.vertices.size() * vertex_record_size + mesh.indices.size() * face_record_size;
+    MappedOutputFile output_file{filename, file_size};
+    if (!output_file.isValid()) {
+        fmt::print(stderr, "Failed to open {}\n", filename);
+        return false;
+    }
+
+    std::memcpy(output_file.data(), header.data(), header.size());
+    char *const vertex_data = output_file.data() + header.size();
+    char *const face_data = vertex_data + mesh.vertices.size() * vertex_record_size;
+
+    std::vector<std::size_t> triangle_indices(mesh.indices.size());
+    std::iota(triangle_indices.begin(), triangle_indices.end(), 0);
+    std::for_each(std::execution::par_unseq, triangle_indices.begin(), triangle_indices.end(), [&](std::size_t triangle_index) noexcept {
+        const glm::uint8 num_corners = 3;
+        char *face_record = face_data + triangle_index * face_record_size;
+        std::memcpy(face_record, &num_corners, sizeof(num_corners));
+        std::memcpy(face_record + sizeof(num_corners), &mesh.indices[triangle_index], 3 * sizeof(glm::uint32));
+    });
+
+    for (std::size_t i = 0; i < mesh.vertices.size(); ++i) {
+        std::memcpy(vertex_data + i * vertex_record_size, &mesh.vertices[i], vertex_record_size);
+    }
+
+    return true;
+}
+
+/// valid bricks of one mip as colored points, or valid and invalid ones apart with `debug_brick`, false if a file cannot be written
+template <DistanceField::BrickConfig Config>
+bool dump_mip_vertices(DistanceFieldMipView const &mip, glm::uint32 num_bricks, std::string const &mip_prefix, bool debug_brick) {
+    // bricks without vertices get no task at all
+    std::vector<DistanceFieldDumpTask<Config>> dump_tasks;
+    std::vector<DistanceFieldDumpTask<Config>> invalid_dump_tasks;
+    dump_tasks.reserve(num_bricks);
+
+    for (DistanceFieldMipBrick const &brick : mip.getBricks()) {
+        const bool is_valid_brick = brick.brick_index != DistanceField::INVALID_BRICK_INDEX;
+        if (!is_valid_brick && !debug_brick) continue;
+
+        auto &target_tasks = is_valid_brick ? dump_tasks : invalid_dump_tasks;
+        target_tasks.emplace_back(mip, brick, !debug_brick);
+    }
+
+    if (debug_brick) {
+        const bool b_valid_written = dump_vertex<Config>(fmt::format("{}_valid_bricks.ply", mip_prefix).c_str(), dump_tasks);
+        const bool b_invalid_written = dump_vertex<Config>(fmt::format("{}_invalid_bricks.ply", mip_prefix).c_str(), invalid_dump_tasks);
+        return b_valid_written && b_invalid_written;
+    }
+    return dump_vertex<Config>(fmt::format("{}_color.ply", mip_prefix).c_str(), dump_tasks);
+}
+
+template <DistanceField::BrickConfig Config>
+Mesh extract_iso_surface(DistanceFieldMipView const &mip, glm::uint32 num_bricks) {
+    std::vector<IsoSurfaceBrickTask<Config>> surface_tasks;
+    surface_tasks.reserve(num_bricks);
+
+    const std::vector<DistanceFieldMipBrick> bricks = mip.getBricks();
+    const glm::uint32 finest_level = std::ranges::max(bricks, std::less{}, &DistanceFieldMipBrick::level).level;
+    for (DistanceFieldMipBrick const &brick : bricks) {
+        if (brick.brick_index != DistanceField::INVALID_BRICK_INDEX) surface_tasks.emplace_back(mip, brick, finest_level);
+    }
+
+    std::for_each(std::execution::par, surface_tasks.begin(), surface_tasks.end(),
+                  [](IsoSurfaceBrickTask<Config> &task) noexcept { task.doWork(); });
+
+    std::vector<std::size_t> vertex_offsets(surface_tasks.size() + 1, 0);
+    std::vector<std::size_t> quad_offsets(surface_tasks.size() + 1, 0);
+    for (std::size_t task_index = 0; task_index < surface_tasks.size(); ++task_index) {
+        vertex_offsets[task_index + 1] = vertex_offsets[task_index] + surface_tasks[task_index].vertices.size();
+        quad_offsets[task_index + 1] = quad_offsets[task_index] + surface_tasks[task_index].quads.size();
+    }
+
+    std::vector<std::size_t> task_indices(surface_tasks.size());
+    std::iota(task_indices.begin(), task_indices.end(), 0);
+
+    // every cell belongs to one brick, so keys are unique
+    Mesh surface;
+    surface.vertices.resize(vertex_offsets.back());
+    std::vector<std::pair<std::uint64_t, glm::uint32>> vertex_of_cell(vertex_offsets.back());
+
+    std::for_each(std::execution::par, task_indices.begin(), task_indices.end(), [&](std::size_t task_index) {
+        IsoSurfaceBrickTask<Config> const &task = surface_tasks[task_index];
+        const std::size_t vertex_offset = vertex_offsets[task_index];
+        for (std::size_t i = 0; i < task.vertices.size(); ++i) {
+            surface.vertices[vertex_offset + i] = task.vertices[i];
+            vertex_of_cell[vertex_offset + i] = {task.cell_keys[i], glm::uint32(vertex_offset + i)};
+        }
+    });
+    std::sort(std::execution::par_unseq, vertex_of_cell.begin(), vertex_of_cell.end());
+
+    // weld, quads look up the vertices of their cells whichever brick produced them
+    constexpr glm::uint32 missing_vertex = DistanceField::INVALID_BRICK_INDEX;
+    const auto find_vertex = [&vertex_of_cell](std::uint64_t cell_key) {
+        const auto found = std::lower_bound(vertex_of_cell.begin(), vertex_of_cell.end(), std::pair{cell_key, glm::uint32(0)});
+        return found != vertex_of_cell.end() && found->first == cell_key ? found->second : missing_vertex;
+    };
+
+    surface.indices.resize(quad_offsets.back() * 2);
+    std::for_each(std::execution::par, task_indices.begin(), task_indices.end(), [&](std::size_t task_index) {
+        IsoSurfaceBrickTask<Config> const &task = surface_tasks[task_index];
+        for (std::size_t i = 0; i < task.quads.size(); ++i) {
+            std::array<glm::uint32, 4> corners;
+            std::ranges::transform(task.quads[i], corners.begin(), find_vertex);
+
+            const std::size_t triangle_offset = (quad_offsets[task_index] + i) * 2;
+            surface.indices[triangle_offset + 0] = {corners[0], corners[1], corners[2]};
+            surface.indices[triangle_offset + 1] = {corners[0], corners[2], corners[3]};
+        }
+    });
+
+    // quads next to cells no brick produced (band clipped by the volume border)
+    std::erase_if(surface.indices, [](glm::uvec3 triangle) {
+        return triangle.x == missing_vertex || triangle.y == missing_vertex || triangle.z == missing_vertex;
+    });
+
+    return surface;
+}
+
+} // namespace
+
+bool dump_sdf_volume_for_visualization(DistanceFieldVolumeData const &volume_data, const char *output_prefix,
+                                       bool debug_brick) noexcept try {
+    bool b_success = true;
+
+    for (glm::uint32 mip_index = 0; mip_index < DistanceField::NUM_MIPS; ++mip_index) {
+        const auto mip = DistanceFieldMipView::create(volume_data, mip_index);
+        if (!mip) continue;
+
+        DistanceField::dispatch_brick_config(mip->brick_config, [&]<DistanceField::BrickConfig Config>() {
+            b_success &= dump_mip_vertices<Config>(*mip, volume_data.mips[mip_index].num_distance_field_bricks,
+                                                   fmt::format("{}{}", output_prefix, mip_index), debug_brick);
+        });
+    }
+
+    return b_success;
+} catch (...) {
+    return false;
+}
+
+Mesh extract_sdf_iso_surface(DistanceFieldVolumeData const &volume_data, glm::uint32 mip_index) {
+    const auto mip = DistanceFieldMipView::create(volume_data, mip_index);
+    if (!mip) return {};
+
+    Mesh surface;
+    DistanceField::dispatch_brick_config(mip->brick_config, [&]<DistanceField::BrickConfig Config>() {
+        surface = extract_iso_surface<Config>(*mip, volume_data.mips[mip_index].num_distance_field_bricks);
+    });
+    return surface;
+}
+
+bool dump_sdf_iso_surface(DistanceFieldVolumeData const &volume_data, const char *output_prefix) noexcept try {
+    bool b_success = true;
+
+    for (glm::uint32 mip_index = 0; mip_index < DistanceField::NUM_MIPS; ++mip_index) {
+        if (volume_data.mips[mip_index].indirection_dimensions.x == 0) continue;
+
+        const Mesh surface = extract_sdf_iso_surface(volume_data, mip_index);
+        b_success &= dump_mesh(fmt::format("{}{}_surface.ply", output_prefix, mip_index).c_str(), surface);
+    }
+
+    return b_success;
+} catch (...) {
+    return false;
+}
@@ -0,0 +1,290 @@
+#include "sdf_math.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+Plane::Plane(glm::dvec3 const &point, glm::dvec3 const &normal) : plane_point_(point), normal_{glm::normalize(normal)} {}
+
+Plane::Plane(glm::dvec3 const &A, glm::dvec3 const &B, glm::dvec3 const &C)
+    : plane_point_{A}, normal_{glm::normalize(glm::cross(B - A, C - B))} {}
+
+double Plane::planeDot(const glm::dvec3 &P) {
+    return glm::dot(P - plane_point_, normal_);
+}
+
+glm::dvec3 Plane::pointProjection(glm::dvec3 const &P) {
+    return P - glm::dot(P - plane_point_, normal_) * normal_;
+}
+
+glm::dvec3 closest_point_on_segment(glm::dvec3 const &P, glm::dvec3 const &start, glm::dvec3 const &end) {
+    const glm::dvec3 segment = end - start;
+    const glm::dvec3 vec_to_point = P - start;
+
+    const double dot1 = glm::dot(vec_to_point, segment);
+    if (dot1 <= 0) {
+        return start;
+    }
+
+    const double dot2 = glm::dot(segment, segment);
+    if (dot2 <= dot1) {
+        return end;
+    }
+
+    return start + segment * (dot1 / dot2);
+}
+
+glm::dvec3 closest_point_on_triangle(glm::dvec3 const &P, glm::dvec3 const &A, glm::dvec3 const &B, glm::dvec3 const &C) {
+    TriangleFeature feature;
+    return closest_point_on_triangle(P, A, B, C, feature);
+}
+
+glm::dvec3 closest_point_on_triangle(glm::dvec3 const &P, glm::dvec3 const &A, glm::dvec3 const &B, glm::dvec3 const &C,
+                                     TriangleFeature &out_feature) {
+    // voronoi regions of the triangle features [C. Ericson; 2005; Real-Time Collision Detection, 5.1.5]
+    const glm::dvec3 AB = B - A;
+    const glm::dvec3 AC = C - A;
+
+    const glm::dvec3 AP = P - A;
+    const double d1 = glm::dot(AB, AP);
+    const double d2 = glm::dot(AC, AP);
+    if (d1 <= 0 && d2 <= 0) { // vertex A
+        out_feature = TriangleFeature::vertex_a;
+        return A;
+    }
+
+    const glm::dvec3 BP = P - B;
+    const double d3 = glm::dot(AB, BP);
+    const double d4 = glm::dot(AC, BP);
+    if (d3 >= 0 && d4 <= d3) { // vertex B
+        out_feature = TriangleFeature::vertex_b;
+        return B;
+    }
+
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) { // edge AB
+        out_feature = TriangleFeature::edge_ab;
+        return A + AB * (d1 / (d1 - d3));
+    }
+
+    const glm::dvec3 CP = P - C;
+    const double d5 = glm::dot(AB, CP);
+    const double d6 = glm::dot(AC, CP);
+    if (d6 >= 0 && d5 <= d6) { // vertex C
+        out_feature = TriangleFeature::vertex_c;
+        return C;
+    }
+
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) { // edge AC
+        out_feature = TriangleFeature::edge_ca;
+        return A + AC * (d2 / (d2 - d6));
+    }
+
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) { // edge BC
+        out_feature = TriangleFeature::edge_bc;
+        return B + (C - B) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    const double denom = va + vb + vc;
+    if (denom <= 0) {
+        // zero-area triangle, closest point lies on one of its edges
+        const std::array<glm::dvec3, 3> candidates = {
+            closest_point_on_segment(P, A, B),
+            closest_point_on_segment(P, B, C),
+            closest_point_on_segment(P, C, A),
+        };
+        const auto closest = std::min_element(candidates.begin(), candidates.end(), [&P](glm::dvec3 const &lhs, glm::dvec3 const &rhs) {
+            return glm::dot(lhs - P, lhs - P) < glm::dot(rhs - P, rhs - P);
+        });
+        constexpr std::array<TriangleFeature, 3> edges = {TriangleFeature::edge_ab, TriangleFeature::edge_bc, TriangleFeature::edge_ca};
+        out_feature = edges[closest - candidates.begin()];
+        return *closest;
+    }
+
+    // inside face
+    out_feature = TriangleFeature::face;
+    return A + AB * (vb / denom) + AC * (vc / denom);
+}
+
+namespace {
+
+/// zero for degenerate input, which collapses the closest point onto an edge start
+float safe_inverse(float value) {
+    return value > 0 ? 1.0f / value : 0.0f;
+}
+
+float sign(float value) {
+    return float(value > 0) - float(value < 0);
+}
+
+std::uint64_t spread_bits_21(std::uint64_t value) {
+    value &= 0x1fffff;
+    value = (value | value << 32) & 0x1f00000000ffff;
+    value = (value | value << 16) & 0x1f0000ff0000ff;
+    value = (value | value << 8) & 0x100f00f00f00f00f;
+    value = (value | value << 4) & 0x10c30c30c30c30c3;
+    value = (value | value << 2) & 0x1249249249249249;
+    return value;
+}
+
+float segment_distance_sq(glm::vec3 const &edge, glm::vec3 const &vec_to_point, float inv_edge_sq) {
+    const glm::vec3 delta = edge * glm::clamp(glm::dot(edge, vec_to_point) * inv_edge_sq, 0.0f, 1.0f) - vec_to_point;
+    return glm::dot(delta, delta);
+}
+
+} // namespace
+
+TriangleSoupDistance::TriangleSoupDistance(std::span<const glm::vec3> triangle_vertices) {
+    triangles_.reserve(triangle_vertices.size() / 3);
+
+    for (std::size_t i = 0; i + 2 < triangle_vertices.size(); i += 3) {
+        Triangle &triangle = triangles_.emplace_back();
+        triangle.A = triangle_vertices[i + 0];
+        triangle.B = triangle_vertices[i + 1];
+        triangle.C = triangle_vertices[i + 2];
+
+        triangle.BA = triangle.B - triangle.A;
+        triangle.CB = triangle.C - triangle.B;
+        triangle.AC = triangle.A - triangle.C;
+        triangle.normal = glm::cross(triangle.BA, triangle.AC);
+
+        triangle.BA_side = glm::cross(triangle.BA, triangle.normal);
+        triangle.CB_side = glm::cross(triangle.CB, triangle.normal);
+        triangle.AC_side = glm::cross(triangle.AC, triangle.normal);
+
+        triangle.inv_BA_sq = safe_inverse(glm::dot(triangle.BA, triangle.BA));
+        triangle.inv_CB_sq = safe_inverse(glm::dot(triangle.CB, triangle.CB));
+        triangle.inv_AC_sq = safe_inverse(glm::dot(triangle.AC, triangle.AC));
+        triangle.inv_normal_sq = safe_inverse(glm::dot(triangle.normal, triangle.normal));
+    }
+}
+
+void TriangleSoupDistance::minDistanceSquared(std::span<const float> xs, std::span<const float> ys, std::span<const float> zs,
+                                              std::span<float> in_out_distance_sq) const {
+    minDistanceSquared<false>(xs, ys, zs, in_out_distance_sq, {});
+}
+
+void TriangleSoupDistance::minDistanceSquared(std::span<const float> xs, std::span<const float> ys, std::span<const float> zs,
+                                              std::span<float> in_out_distance_sq, std::span<std::uint32_t> in_out_closest_triangle) const {
+    assert(in_out_closest_triangle.size() == in_out_distance_sq.size());
+    minDistanceSquared<true>(xs, ys, zs, in_out_distance_sq, in_out_closest_triangle);
+}
+
+template <bool b_track_closest>
+void TriangleSoupDistance::minDistanceSquared(std::span<const float> xs, std::span<const float> ys, std::span<const float> zs,
+                                              std::span<float> in_out_distance_sq, std::span<std::uint32_t> in_out_closest_triangle) const {
+    assert(xs.size() == ys.size() && xs.size() == zs.size() && xs.size() == in_out_distance_sq.size());
+
+    for (std::uint32_t triangle_index = 0; triangle_index < triangles_.size(); ++triangle_index) {
+        Triangle const &triangle = triangles_[triangle_index];
+
+        for (std::size_t i = 0; i < xs.size(); ++i) {
+            const glm::vec3 P{xs[i], ys[i], zs[i]};
+            const glm::vec3 PA = P - triangle.A;
+            const glm::vec3 PB = P - triangle.B;
+            const glm::vec3 PC = P - triangle.C;
+
+            // evaluate both cases and select, the projection is inside only if P is on the inner side of all 3 edges
+            const float inside = sign(glm::dot(triangle.BA_side, PA)) + sign(glm::dot(triangle.CB_side, PB)) +
+                                 sign(glm::dot(triangle.AC_side, PC));
+
+            const float edge_distance_sq = std::min(std::min(segment_distance_sq(triangle.BA, PA, triangle.inv_BA_sq),
+                                                             segment_distance_sq(triangle.CB, PB, triangle.inv_CB_sq)),
+                                                    segment_distance_sq(triangle.AC, PC, triangle.inv_AC_sq));
+            const float plane_distance = glm::dot(triangle.normal, PA);
+            const float face_distance_sq = plane_distance * plane_distance * triangle.inv_normal_sq;
+
+            const float distance_sq = inside < 2.0f ? edge_distance_sq : face_distance_sq;
+            if constexpr (b_track_closest) { // selects, not branches, to stay vectorizable
+                in_out_closest_triangle[i] = distance_sq < in_out_distance_sq[i] ? triangle_index : in_out_closest_triangle[i];
+            }
+            in_out_distance_sq[i] = std::min(in_out_distance_sq[i], distance_sq);
+        }
+    }
+}
+
+// ---------- space filling curve -----------
+
+std::uint64_t morton_encode(glm::uvec3 cell) {
+    return spread_bits_21(cell.x) | spread_bits_21(cell.y) << 1 | spread_bits_21(cell.z) << 2;
+}
+
+// ---------- sample directions -----------
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+constexpr double constexpr_sqrt(double value) {
+    if (value <= 0.0) return 0.0;
+    double root = value < 1.0 ? 1.0 : value;
+    for (int i = 0; i < 64; ++i) root = 0.5 * (root + value / root);
+    return root;
+}
+
+/// Taylor series after reducing `angle` to [-pi, pi], exact to double precision there
+constexpr void constexpr_sin_cos(double angle, double &out_sin, double &out_cos) {
+    const double turns = angle / (2.0 * PI);
+    angle -= 2.0 * PI * (double) (long long) (turns + (turns < 0.0 ? -0.5 : 0.5));
+
+    double sin_term = angle, cos_term = 1.0;
+    out_sin = 0.0;
+    out_cos = 0.0;
+    for (int n = 1; n < 40; n += 2) {
+        out_sin += sin_term;
+        out_cos += cos_term;
+        sin_term *= -angle * angle / ((n + 1) * (n + 2));
+        cos_term *= -angle * angle / (n * (n + 1));
+    }
+}
+
+template <std::size_t N>
+using DirectionTable = std::array<std::array<float, 3>, N>;
+
+/// spherical Fibonacci lattice: equal-area bands in z, consecutive points a golden angle apart around it
+template <std::size_t N>
+constexpr DirectionTable<N> make_fibonacci_sphere_table() {
+    const double golden_angle = PI * (3.0 - constexpr_sqrt(5.0));
+
+    DirectionTable<N> table{};
+    for (std::size_t i = 0; i < N; ++i) {
+        const double z = 1.0 - (2.0 * (double) i + 1.0) / (double) N;
+        const double radius = constexpr_sqrt(1.0 - z * z);
+        double sin_phi = 0.0, cos_phi = 0.0;
+        constexpr_sin_cos(golden_angle * (double) i, sin_phi, cos_phi);
+        table[i] = {(float) (radius * cos_phi), (float) (radius * sin_phi), (float) z};
+    }
+    return table;
+}
+
+constexpr auto SPHERE_DIRECTIONS_16 = make_fibonacci_sphere_table<16>();
+constexpr auto SPHERE_DIRECTIONS_32 = make_fibonacci_sphere_table<32>();
+constexpr auto SPHERE_DIRECTIONS_48 = make_fibonacci_sphere_table<48>();
+constexpr auto SPHERE_DIRECTIONS_64 = make_fibonacci_sphere_table<64>();
+constexpr auto SPHERE_DIRECTIONS_96 = make_fibonacci_sphere_table<96>();
+
+static_assert(SPHERE_DIRECTION_COUNTS.back() == SPHERE_DIRECTIONS_96.size());
+
+template <std::size_t N>
+std::span<const glm::vec3> as_vectors(DirectionTable<N> const &table) {
+    // one static per table, a plain copy of the compile-time data
+    static const std::array<glm::vec3, N> vectors = [&table] {
+        std::array<glm::vec3, N> res;
+        for (std::size_t i = 0; i < N; ++i) res[i] = {table[i][0], table[i][1], table[i][2]};
+        return res;
+    }();
+    return vectors;
+}
+
+} // namespace
+
+std::span<const glm::vec3> fibonacci_sphere_directions(std::uint32_t num_directions) {
+    if (num_directions <= 16) return as_vectors(SPHERE_DIRECTIONS_16);
+    if (num_directions <= 32) return as_vectors(SPHERE_DIRECTIONS_32);
+    if (num_directions <= 48) return as_vectors(SPHERE_DIRECTIONS_48);
+    if (num_directions <= 64) return as_vectors(SPHERE_DIRECTIONS_64);
+    return as_vectors(SPHERE_DIRECTIONS_96);
+}
\ No newline at end of file
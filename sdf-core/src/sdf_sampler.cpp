@@ -0,0 +1,115 @@
+#include "sdf_sampler.h"
+
+#include <glm/common.hpp>
+
+std::optional<DistanceFieldMipView> DistanceFieldMipView::create(DistanceFieldVolumeData const &volume_data, glm::uint32 mip_index) {
+    SparseDistanceFieldMip const &mip = volume_data.mips[mip_index];
+    if (mip.indirection_dimensions.x == 0) return std::nullopt;
+
+    const glm::uvec3 dimensions = mip.indirection_dimensions;
+    const std::size_t indirection_table_size_bytes = mip.getIndirectionTableSize() * sizeof(glm::uint32);
+    const glm::uint32 brick_size_bytes = DistanceField::get_brick_size_bytes(volume_data.encoding, volume_data.brick_config);
+    const glm::uint32 brick_scale_bias_bytes = DistanceField::has_brick_scale_bias(volume_data.encoding) ? sizeof(glm::vec2) : 0;
+    const std::size_t mip_data_size =
+        indirection_table_size_bytes + std::size_t(brick_size_bytes + brick_scale_bias_bytes) * mip.num_distance_field_bricks;
+
+    DistanceFieldMipView view{.dimensions = dimensions,
+                              .encoding = volume_data.encoding,
+                              .brick_config = volume_data.brick_config,
+                              .distance_field_to_volume_scale_bias = mip.distance_field_to_volume_scale_bias};
+
+    const glm::uint8 *mip_data = nullptr;
+    if (mip_index == DistanceField::NUM_MIPS - 1) {
+        assert(volume_data.always_loaded_mip.size() == mip_data_size);
+        mip_data = volume_data.always_loaded_mip.data();
+    } else {
+        assert(mip.bulk_size == mip_data_size);
+        mip_data = volume_data.streamable_mips.data() + mip.bulk_offset;
+    }
+
+    assert(mip_data);
+    view.indirection_table = reinterpret_cast<const glm::uint32 *>(mip_data);
+    view.brick_data = mip_data + indirection_table_size_bytes;
+    if (brick_scale_bias_bytes != 0) {
+        // per-brick table after the bricks
+        view.brick_scale_bias =
+            reinterpret_cast<const glm::vec2 *>(view.brick_data + std::size_t(brick_size_bytes) * mip.num_distance_field_bricks);
+    }
+
+    Box const &mesh_bounds = volume_data.local_space_mesh_bounds;
+    view.voxel_size = mesh_bounds.getSize() / glm::vec3(dimensions * volume_data.brick_config.getUniqueDataBrickSize() -
+                                                        2 * DistanceField::MESH_DISTANCE_FIELD_OBJECT_BORDER);
+    view.volume_bounds = mesh_bounds.expandBy(view.voxel_size);
+    return view;
+}
+
+std::vector<DistanceFieldMipBrick> DistanceFieldMipView::getBricks() const {
+    std::vector<DistanceFieldMipBrick> bricks;
+
+    const auto add_entry = [&](auto const &add_entry, glm::uint32 entry, glm::uvec3 coordinate, glm::uint32 level) -> void {
+        if (!DistanceField::is_refined_entry(entry)) {
+            bricks.push_back({entry, coordinate, level});
+            return;
+        }
+        const glm::uint32 block_offset = entry & ~DistanceField::REFINED_BRICK_FLAG;
+        for (glm::uint32 child_index = 0; child_index < 8; ++child_index) {
+            const glm::uvec3 child{child_index & 1, child_index >> 1 & 1, child_index >> 2 & 1};
+            add_entry(add_entry, indirection_table[block_offset + child_index], 2u * coordinate + child, level + 1);
+        }
+    };
+
+    const glm::uint32 indirection_table_size = dimensions.x * dimensions.y * dimensions.z;
+    bricks.reserve(indirection_table_size);
+    for (glm::uint32 index = 0; index < indirection_table_size; ++index) {
+        const glm::uvec3 coordinate{index % dimensions.x, index / dimensions.x % dimensions.y, index / dimensions.x / dimensions.y};
+        add_entry(add_entry, indirection_table[index], coordinate, 0);
+    }
+    return bricks;
+}
+
+DistanceFieldSampler::DistanceFieldSampler(DistanceFieldMipView const &mip, Box const &local_space_mesh_bounds)
+    : mip_{mip}, volume_to_local_scale_{std::max(local_space_mesh_bounds.getExtent().x,
+                                                 std::max(local_space_mesh_bounds.getExtent().y, local_space_mesh_bounds.getExtent().z))} {}
+
+float DistanceFieldSampler::sample(glm::vec3 local_position) const {
+    const glm::vec2 scale_bias = mip_.distance_field_to_volume_scale_bias;
+    const auto decode = [&](float normalized) { return (normalized * scale_bias.x + scale_bias.y) * volume_to_local_scale_; };
+
+    const glm::uint32 brick_size = mip_.brick_config.brick_size;
+    const glm::uint32 unique_data_brick_size = mip_.brick_config.getUniqueDataBrickSize();
+
+    // continuous sample coordinate over the whole mip, bricks share their border layer
+    const glm::vec3 max_coordinate = glm::vec3(mip_.dimensions * unique_data_brick_size);
+    const glm::vec3 sample_coordinate =
+        glm::clamp((local_position - mip_.volume_bounds.min) / mip_.voxel_size, glm::vec3(0.0f), max_coordinate);
+
+    const glm::uvec3 brick_coordinate =
+        glm::min(glm::uvec3(sample_coordinate / float(unique_data_brick_size)), mip_.dimensions - 1u);
+    glm::uint32 brick_index =
+        mip_.indirection_table[(brick_coordinate.z * mip_.dimensions.y + brick_coordinate.y) * mip_.dimensions.x + brick_coordinate.x];
+    glm::vec3 brick_local = sample_coordinate - glm::vec3(brick_coordinate * unique_data_brick_size);
+
+    // down the split bricks, each child covers half of its parent with the same number of voxels
+    while (DistanceField::is_refined_entry(brick_index)) {
+        const glm::uvec3 child = glm::min(glm::uvec3(brick_local * (2.0f / float(unique_data_brick_size))), glm::uvec3(1));
+        brick_local = 2.0f * brick_local - glm::vec3(child * unique_data_brick_size);
+        brick_index = mip_.indirection_table[(brick_index & ~DistanceField::REFINED_BRICK_FLAG) + (child.z * 2 + child.y) * 2 + child.x];
+    }
+    if (brick_index == DistanceField::INVALID_BRICK_INDEX) return decode(1.0f);
+    const glm::uvec3 base = glm::min(glm::uvec3(brick_local), glm::uvec3(brick_size - 2));
+    const glm::vec3 weight = brick_local - glm::vec3(base);
+
+    const auto voxel = [&](glm::uint32 x, glm::uint32 y, glm::uint32 z) {
+        return mip_.getVoxel(brick_index, (z * brick_size + y) * brick_size + x);
+    };
+
+    float normalized = 0;
+    for (glm::uint32 corner = 0; corner < 8; ++corner) {
+        const glm::uvec3 offset{corner & 1, corner >> 1 & 1, corner >> 2 & 1};
+        const float corner_weight = (offset.x ? weight.x : 1.0f - weight.x) * (offset.y ? weight.y : 1.0f - weight.y) *
+                                    (offset.z ? weight.z : 1.0f - weight.z);
+        normalized += corner_weight * voxel(base.x + offset.x, base.y + offset.y, base.z + offset.z);
+    }
+
+    return decode(normalized);
+}
@@ -0,0 +1,8 @@
+add_requires("fmt", "embree", "glm", "assimp")
+
+target("sdf-core")
+    set_kind("static")
+    add_files("src/*.cpp")
+    add_includedirs("include", {public = true})
+    add_packages("fmt", "embree", "glm", "assimp", {public = true})
+    
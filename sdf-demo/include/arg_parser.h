@@ -1,5 +1,10 @@
 #pragma once
 
+#include "bake_pipeline.h"
+#include "bake_server.h"
+#include "local_sdf.h"
+#include "shard_coordinator.h"
+
 template <typename T>
 class Singleton {
 public:
@@ -20,11 +25,30 @@ class ArgParser : public Singleton<ArgParser> {
 public:
     const char *input_filename = "meshes/test_sphere.ply";
     const char *output_filename = "DF_OUTPUT";
-    float voxel_density = 0.2;
-    float df_resolution_scale = 1.0; // per mesh in ue5
+    const char *serve_socket = nullptr; // serve bake jobs on this Unix domain socket instead of baking the input
+    const char *batch_list = nullptr;   // bake every model listed in this file, one path per line, instead of the input
+    const char *csg_operand = nullptr;  // baked volume (.bin) combined with the bake before it is written, see csg_settings
+    float df_resolution_scale = 1.0;    // per mesh in ue5
     float display_distance = 0.0f;
     bool debug_brick = false;
-    bool parallel = true;
+    bool dump_surface = false;     // also write the iso-surface of each mip as a mesh
+    bool two_sided = false;        // force unsigned bake, no sign rays
+    bool detect_two_sided = false; // bake open meshes as two-sided
+    float time_budget = 0.0f;      // progressive bake stopping after this many seconds, 0 to bake everything
+    bool use_assimp = false;       // skip the native PLY/OBJ readers
+    bool preprocess = false;       // weld, drop degenerate triangles and Morton-sort the mesh before baking
+    float weld_distance = 0.0f;    // 0 only welds exactly coincident vertices
+    bool bench_preprocess = false; // bake the input as read then preprocessed and report the bake time it saves
+    std::size_t bench_samples = 0; // random sampling benchmark on the baked volume, 0 to skip
+    std::size_t bench_queries = 0; // batched closest point queries on the input mesh, 0 to skip
+    std::size_t atlas_budget = 0;  // stream the written volume back through a brick atlas of this many bytes, 0 to skip
+    BakeSettings bake_settings;
+    ShardedBakeSettings shard_settings;
+    BakeServerSettings server_settings;
+    BakePipelineSettings pipeline_settings;
+    CsgSettings csg_settings;
+    bool all_meshes = false;               // bake every mesh of the input into one volume, not only the first
+    std::vector<glm::vec3> repeat_offsets; // one more placement of the input per offset, instances share its BVH
 
     ArgParser(_ /*unused*/){};
     void parseCommandLine(int argc, const char *argv[]);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "local_sdf.h"
+#include "mesh.h"
+
+#include <functional>
+#include <vector>
+
+struct BakePipelineSettings {
+    glm::uint32 max_loaded_assets = 1;  // imported assets waiting for the bake, loading runs this far ahead of it
+    glm::uint32 max_pending_writes = 1; // baked volumes waiting for an I/O thread, the bake stalls beyond
+    glm::uint32 num_io_threads = 2;
+};
+
+/// stages of a multi-asset bake, all given the index of the asset. `load` runs on a loader thread, `bake` on the thread running the
+/// pipeline and `write` on the I/O threads. An asset whose load or bake fails skips the remaining stages
+struct BakePipelineStages {
+    std::function<bool(std::size_t asset_index, std::vector<Mesh> &out_meshes)> load;
+    std::function<bool(std::size_t asset_index, std::vector<Mesh> const &meshes, DistanceFieldVolumeData &out_data)> bake;
+    std::function<bool(std::size_t asset_index, DistanceFieldVolumeData const &data)> write;
+};
+
+/// loads asset N+1 while asset N bakes and earlier ones are written, so a run takes about as long as its slowest stage rather than
+/// the sum of all. Bounded queues between the stages make a fast stage wait for the next one: at most `max_loaded_assets` + 2 mesh
+/// sets and `max_pending_writes` + `num_io_threads` + 1 volumes are alive at a time.
+/// \return number of assets that went through all stages
+std::size_t run_bake_pipeline(std::size_t num_assets, BakePipelineSettings const &settings, BakePipelineStages const &stages);
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "local_sdf.h"
+
+struct BakeServerSettings {
+    glm::uint32 max_concurrent_jobs = 2;
+    std::size_t memory_limit = std::size_t(4) << 30; // estimated bytes of all running jobs together, a larger job runs alone
+    glm::uint32 request_timeout_seconds = 30;        // longest wait for the next bytes of a request, 0 waits forever
+};
+
+/// long-running bake service on a Unix domain socket, keeping the Embree device and sample directions warm between jobs.
+/// One request per connection, a text line then the inline mesh bytes if any:
+///
+///   BAKE mesh=<path> [options]                        mesh file readable by the server
+///   BAKE inline=<size> format=<ply|obj|...> [options] followed by <size> bytes of mesh file, at most `memory_limit`
+///   SHUTDOWN                                          stop accepting jobs, exit once queued ones are done
+///
+/// options: scale=<float> voxel_density=<float> two_sided=<0|1|detect> morton=<0|1>
+///          encoding=<uniform8|brick4|brick8|brick16> brick_size=<4|8|16> refine=<levels> output=<path>
+///          lod_error=<fraction of voxel diagonal> sign=<rays|pseudo>
+///
+/// reply: `DATA <size>\n` then the serialized DistanceFieldVolumeData, `FILE <path>\n` once written to `output`, or `ERROR <reason>\n`.
+/// Requests are read on a thread per connection, a client stalling longer than `request_timeout_seconds` is dropped.
+/// Jobs start in arrival order, each with `default_settings` overridden by its options.
+/// false if the socket cannot be opened
+bool run_bake_server(const char *socket_path, BakeServerSettings const &settings, BakeSettings const &default_settings);
\ No newline at end of file
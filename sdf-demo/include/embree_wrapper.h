@@ -1,85 +0,0 @@
-#pragma once
-
-#include <embree4/rtcore.h>
-#include <embree4/rtcore_ray.h>
-#include <glm/vec3.hpp>
-#include <span>
-#include <vector>
-
-struct Mesh;
-
-namespace embree {
-
-struct Geometry {
-    std::span<const glm::uvec3> indices_buffer;
-    std::span<const glm::vec3> vertices_buffer;
-    RTCGeometry handle = nullptr; // transformed geometry handle
-};
-
-class Scene {
-public:
-    Scene();
-    ~Scene();
-
-    Scene(const Scene &) = delete;
-    Scene operator=(const Scene &) = delete;
-
-    void addMesh(Mesh const &mesh);
-
-    void commit();
-
-    RTCDevice device_;
-    RTCScene scene_;
-    std::vector<Geometry> geos_;
-};
-
-class RayHit : public RTCRayHit {
-public:
-    RayHit(glm::vec3 const &origin, glm::vec3 const &direction, float far);
-
-    [[nodiscard]] glm::vec3 getHitNormal() const;
-    [[nodiscard]] bool isValidHit() const { return hit.geomID != RTC_INVALID_GEOMETRY_ID && hit.primID != RTC_INVALID_GEOMETRY_ID; }
-};
-
-class IntersectionContext : public RTCIntersectArguments {
-public:
-    IntersectionContext(Scene const &scene) : scene_{scene.scene_} { rtcInitIntersectArguments(this); }
-
-    RayHit emitRay(glm::vec3 const &origin, glm::vec3 const &direction, float far);
-
-    void emitRay(RayHit *rayhit) { rtcIntersect1(scene_, rayhit, this); }
-
-private:
-    RTCScene const &scene_;
-};
-
-class ClosestQueryResult {
-public:
-    glm::vec3 closest_point;
-
-    // not free lunch, will call `sqrt()`
-    [[nodiscard]] float getDistance() const;
-
-private:
-    friend class ClosestQueryContext;
-
-    float query_distance_sq;
-};
-
-class ClosestQueryContext : public RTCPointQueryContext {
-public:
-    ClosestQueryContext(Scene const &scene);
-
-    ClosestQueryResult query(glm::vec3 center, float radius);
-
-    float queryDistance(glm::vec3 center, float radius) { return query(center, radius).getDistance(); }
-
-private:
-    static bool closestQueryFunc(RTCPointQueryFunctionArguments *args);
-
-    RTCScene const &scene_;
-    std::vector<RTCGeometry> mesh_geometries_;
-    std::vector<glm::uint32> num_triangles_;
-};
-
-} // namespace embree
@@ -1,5 +0,0 @@
-#pragma once
-
-class DistanceFieldVolumeData;
-
-bool dump_sdf_volume_for_visualization(DistanceFieldVolumeData const &volume_data) noexcept;
\ No newline at end of file
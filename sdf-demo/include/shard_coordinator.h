@@ -0,0 +1,18 @@
+#pragma once
+
+#include "local_sdf.h"
+
+#include <string>
+#include <vector>
+
+struct ShardedBakeSettings {
+    glm::uint32 num_shards = 1;   // worker processes, 1 bakes in this process
+    glm::uint32 max_attempts = 3; // per shard, crashed or timed out workers are restarted until then
+    float timeout = 0.0f;         // seconds a worker may run before it is killed and restarted, 0 for no limit
+};
+
+/// local coordinator of a multi-process bake. Starts `worker_command` once per shard with `-shard <index> <count> -o <prefix>.shard<index>`
+/// appended, all shards at once, and merges the `.bin` files the workers write into `out_data`.
+/// false once a shard has failed `max_attempts` times or its result cannot be merged
+bool run_sharded_bake(std::vector<std::string> const &worker_command, std::string const &shard_prefix, ShardedBakeSettings const &settings,
+                      BakeSettings const &bake_settings, DistanceFieldVolumeData &out_data);
\ No newline at end of file
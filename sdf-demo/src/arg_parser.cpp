@@ -18,14 +18,166 @@ void ArgParser::parseCommandLine(int argc, const char *argv[]) {
             output_filename = argv[i];
         } else if (strcmp(argv[i], "-v") == 0) {
             next_and_check(i);
-            voxel_density = (float) atof(argv[i]);
+            bake_settings.voxel_density = (float) atof(argv[i]);
         } else if (strcmp(argv[i], "-scale") == 0) {
             next_and_check(i);
             df_resolution_scale = (float) atof(argv[i]);
         } else if (strcmp(argv[i], "-no-parallel") == 0) {
-            parallel = false;
+            bake_settings.parallel = false;
         } else if (strcmp(argv[i], "-brick") == 0) {
             debug_brick = true;
+        } else if (strcmp(argv[i], "-numa") == 0) {
+            bake_settings.numa_placement = true;
+        } else if (strcmp(argv[i], "-numa-simulate") == 0) {
+            next_and_check(i);
+            bake_settings.numa_placement = true;
+            bake_settings.numa_simulated_nodes = (glm::uint32) atoi(argv[i]);
+        } else if (strcmp(argv[i], "-numa-replicate") == 0) {
+            bake_settings.numa_placement = true;
+            bake_settings.numa_replicate_scenes = true;
+        } else if (strcmp(argv[i], "-morton") == 0) {
+            bake_settings.morton_brick_order = true;
+        } else if (strcmp(argv[i], "-sign-rays") == 0) {
+            next_and_check(i);
+            bake_settings.num_sign_rays.fill((glm::uint32) atoi(argv[i]));
+        } else if (strcmp(argv[i], "-sign") == 0) {
+            next_and_check(i);
+            bake_settings.sign_mode = strcmp(argv[i], "pseudo") == 0 ? SignMode::pseudo_normal : SignMode::ray_vote;
+        } else if (strcmp(argv[i], "-brick-size") == 0) {
+            next_and_check(i);
+            if (strcmp(argv[i], "4") == 0) {
+                bake_settings.brick_config = DistanceField::BRICK_CONFIG_4;
+            } else if (strcmp(argv[i], "16") == 0) {
+                bake_settings.brick_config = DistanceField::BRICK_CONFIG_16;
+            } else {
+                bake_settings.brick_config = DistanceField::BRICK_CONFIG_8;
+            }
+        } else if (strcmp(argv[i], "-refine") == 0) {
+            next_and_check(i);
+            bake_settings.refinement_levels = (glm::uint32) atoi(argv[i]);
+        } else if (strcmp(argv[i], "-refine-error") == 0) {
+            next_and_check(i);
+            bake_settings.refinement_error = (float) atof(argv[i]);
+        } else if (strcmp(argv[i], "-lod-error") == 0) {
+            next_and_check(i);
+            bake_settings.coarse_mip_lod_error = (float) atof(argv[i]);
+        } else if (strcmp(argv[i], "-encoding") == 0) {
+            next_and_check(i);
+            if (strcmp(argv[i], "brick4") == 0) {
+                bake_settings.encoding = DistanceField::Encoding::brick_4bit;
+            } else if (strcmp(argv[i], "brick8") == 0) {
+                bake_settings.encoding = DistanceField::Encoding::brick_8bit;
+            } else if (strcmp(argv[i], "brick16") == 0) {
+                bake_settings.encoding = DistanceField::Encoding::brick_16bit;
+            } else {
+                bake_settings.encoding = DistanceField::Encoding::uniform_8bit;
+            }
+        } else if (strcmp(argv[i], "-encoding-report") == 0) {
+            bake_settings.encoding_report = true;
+        } else if (strcmp(argv[i], "-bench-sampling") == 0) {
+            next_and_check(i);
+            bench_samples = (std::size_t) atoll(argv[i]);
+        } else if (strcmp(argv[i], "-bench-query") == 0) {
+            next_and_check(i);
+            bench_queries = (std::size_t) atoll(argv[i]);
+        } else if (strcmp(argv[i], "-atlas-budget") == 0) {
+            next_and_check(i);
+            atlas_budget = (std::size_t) (atof(argv[i]) * 1024 * 1024);
+        } else if (strcmp(argv[i], "-surface") == 0) {
+            dump_surface = true;
+        } else if (strcmp(argv[i], "-two-sided") == 0) {
+            two_sided = true;
+        } else if (strcmp(argv[i], "-detect-two-sided") == 0) {
+            detect_two_sided = true;
+        } else if (strcmp(argv[i], "-no-binning") == 0) {
+            bake_settings.triangle_binning = false;
+        } else if (strcmp(argv[i], "-chunk-triangles") == 0) {
+            next_and_check(i);
+            bake_settings.max_chunk_triangles = (std::size_t) atoll(argv[i]);
+        } else if (strcmp(argv[i], "-budget") == 0) {
+            next_and_check(i);
+            time_budget = (float) atof(argv[i]);
+        } else if (strcmp(argv[i], "-shards") == 0) {
+            next_and_check(i);
+            shard_settings.num_shards = (glm::uint32) atoi(argv[i]);
+        } else if (strcmp(argv[i], "-shard-attempts") == 0) {
+            next_and_check(i);
+            shard_settings.max_attempts = (glm::uint32) atoi(argv[i]);
+        } else if (strcmp(argv[i], "-shard-timeout") == 0) {
+            next_and_check(i);
+            shard_settings.timeout = (float) atof(argv[i]);
+        } else if (strcmp(argv[i], "-shard") == 0) { // worker of a sharded bake
+            next_and_check(i);
+            bake_settings.shard_index = (glm::uint32) atoi(argv[i]);
+            next_and_check(i);
+            bake_settings.num_shards = (glm::uint32) atoi(argv[i]);
+        } else if (strcmp(argv[i], "-serve") == 0) {
+            next_and_check(i);
+            serve_socket = argv[i];
+        } else if (strcmp(argv[i], "-serve-jobs") == 0) {
+            next_and_check(i);
+            server_settings.max_concurrent_jobs = (glm::uint32) atoi(argv[i]);
+        } else if (strcmp(argv[i], "-serve-memory") == 0) {
+            next_and_check(i);
+            server_settings.memory_limit = (std::size_t) (atof(argv[i]) * 1024 * 1024);
+        } else if (strcmp(argv[i], "-serve-timeout") == 0) {
+            next_and_check(i);
+            server_settings.request_timeout_seconds = (glm::uint32) atoi(argv[i]);
+        } else if (strcmp(argv[i], "-batch") == 0) {
+            next_and_check(i);
+            batch_list = argv[i];
+        } else if (strcmp(argv[i], "-batch-prefetch") == 0) {
+            next_and_check(i);
+            pipeline_settings.max_loaded_assets = (glm::uint32) atoi(argv[i]);
+        } else if (strcmp(argv[i], "-batch-pending-writes") == 0) {
+            next_and_check(i);
+            pipeline_settings.max_pending_writes = (glm::uint32) atoi(argv[i]);
+        } else if (strcmp(argv[i], "-batch-io-threads") == 0) {
+            next_and_check(i);
+            pipeline_settings.num_io_threads = (glm::uint32) atoi(argv[i]);
+        } else if (strcmp(argv[i], "-csg") == 0) {
+            next_and_check(i);
+            if (strcmp(argv[i], "intersect") == 0) {
+                csg_settings.operation = CsgOperation::intersect;
+            } else if (strcmp(argv[i], "subtract") == 0) {
+                csg_settings.operation = CsgOperation::subtract;
+            } else if (strcmp(argv[i], "smooth") == 0) {
+                csg_settings.operation = CsgOperation::smooth_unite;
+            } else {
+                csg_settings.operation = CsgOperation::unite;
+            }
+            next_and_check(i);
+            csg_operand = argv[i];
+        } else if (strcmp(argv[i], "-csg-offset") == 0) {
+            for (glm::uint32 axis = 0; axis < 3; ++axis) {
+                next_and_check(i);
+                csg_settings.b_to_a[3][axis] = (float) atof(argv[i]);
+            }
+        } else if (strcmp(argv[i], "-csg-scale") == 0) {
+            next_and_check(i);
+            const float scale = (float) atof(argv[i]);
+            for (glm::uint32 axis = 0; axis < 3; ++axis) csg_settings.b_to_a[axis][axis] = scale;
+        } else if (strcmp(argv[i], "-csg-smooth") == 0) {
+            next_and_check(i);
+            csg_settings.smooth_radius = (float) atof(argv[i]);
+        } else if (strcmp(argv[i], "-assimp") == 0) {
+            use_assimp = true;
+        } else if (strcmp(argv[i], "-preprocess") == 0) {
+            preprocess = true;
+        } else if (strcmp(argv[i], "-bench-preprocess") == 0) {
+            bench_preprocess = true;
+        } else if (strcmp(argv[i], "-all-meshes") == 0) {
+            all_meshes = true;
+        } else if (strcmp(argv[i], "-repeat") == 0) {
+            glm::vec3 &offset = repeat_offsets.emplace_back();
+            for (glm::uint32 axis = 0; axis < 3; ++axis) {
+                next_and_check(i);
+                offset[axis] = (float) atof(argv[i]);
+            }
+        } else if (strcmp(argv[i], "-weld") == 0) {
+            next_and_check(i);
+            preprocess = true;
+            weld_distance = (float) atof(argv[i]);
         }
     }
 }
\ No newline at end of file
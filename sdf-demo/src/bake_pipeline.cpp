@@ -0,0 +1,133 @@
+#include "bake_pipeline.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fmt/core.h>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace {
+
+/// FIFO between two stages, push waits for room and pop for an item until the queue is closed
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) : capacity_{std::max<std::size_t>(capacity, 1)} {}
+
+    void push(T item) {
+        std::unique_lock lock{mutex_};
+        not_full_.wait(lock, [this] { return items_.size() < capacity_; });
+        items_.push_back(std::move(item));
+        lock.unlock();
+        not_empty_.notify_one();
+    }
+
+    /// nullopt once the queue is closed and drained
+    std::optional<T> pop() {
+        std::unique_lock lock{mutex_};
+        not_empty_.wait(lock, [this] { return b_closed_ || !items_.empty(); });
+        if (items_.empty()) return std::nullopt;
+
+        T item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return item;
+    }
+
+    /// the producer is done, consumers drain what is left
+    void close() {
+        {
+            std::lock_guard lock{mutex_};
+            b_closed_ = true;
+        }
+        not_empty_.notify_all();
+    }
+
+private:
+    const std::size_t capacity_;
+
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<T> items_;
+    bool b_closed_ = false;
+};
+
+struct LoadedAsset {
+    std::size_t asset_index;
+    std::vector<Mesh> meshes;
+};
+
+struct BakedAsset {
+    std::size_t asset_index;
+    DistanceFieldVolumeData data;
+};
+
+enum PipelineStage : glm::uint32 { load_stage, bake_stage, write_stage, num_pipeline_stages };
+
+} // namespace
+
+std::size_t run_bake_pipeline(std::size_t num_assets, BakePipelineSettings const &settings, BakePipelineStages const &stages) {
+    auto pipeline_start_time = std::chrono::steady_clock::now();
+
+    BoundedQueue<LoadedAsset> load_queue{settings.max_loaded_assets};
+    BoundedQueue<BakedAsset> write_queue{settings.max_pending_writes};
+
+    // time each stage spends working, summed over its threads, what a sequential run would add up
+    std::array<std::atomic<std::chrono::steady_clock::rep>, num_pipeline_stages> stage_ticks{};
+    const auto run_stage = [&stage_ticks](PipelineStage stage, auto const &stage_function) {
+        auto stage_start_time = std::chrono::steady_clock::now();
+        const bool b_success = stage_function();
+        auto stage_end_time = std::chrono::steady_clock::now();
+        stage_ticks[stage].fetch_add((stage_end_time - stage_start_time).count(), std::memory_order_relaxed);
+        return b_success;
+    };
+
+    std::thread loader{[&] {
+        for (std::size_t asset_index = 0; asset_index < num_assets; ++asset_index) {
+            LoadedAsset asset{asset_index};
+            if (run_stage(load_stage, [&] { return stages.load(asset_index, asset.meshes); })) load_queue.push(std::move(asset));
+        }
+        load_queue.close();
+    }};
+
+    std::atomic<std::size_t> num_written_assets = 0;
+    std::vector<std::thread> writers;
+    for (glm::uint32 i = 0; i < std::max(settings.num_io_threads, 1u); ++i) {
+        writers.emplace_back([&] {
+            while (std::optional<BakedAsset> asset = write_queue.pop()) {
+                if (run_stage(write_stage, [&] { return stages.write(asset->asset_index, asset->data); })) {
+                    num_written_assets.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    // the bake keeps all cores busy on its own, it runs here and only overlaps with the I/O-bound stages
+    while (std::optional<LoadedAsset> asset = load_queue.pop()) {
+        BakedAsset baked_asset{asset->asset_index};
+        const bool b_baked = run_stage(bake_stage, [&] { return stages.bake(asset->asset_index, asset->meshes, baked_asset.data); });
+        std::vector<Mesh>{}.swap(asset->meshes); // not kept alive while waiting for the writers
+        if (b_baked) write_queue.push(std::move(baked_asset));
+    }
+    write_queue.close();
+
+    loader.join();
+    for (auto &writer : writers) writer.join();
+
+    auto pipeline_end_time = std::chrono::steady_clock::now();
+    const auto stage_seconds = [&stage_ticks](PipelineStage stage) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::duration{stage_ticks[stage].load()}).count();
+    };
+    fmt::print("Pipelined {} of {} assets in {:.1f}s, stages busy for load {:.1f}s, bake {:.1f}s, write {:.1f}s.\n",
+               num_written_assets.load(), num_assets, std::chrono::duration<double>(pipeline_end_time - pipeline_start_time).count(),
+               stage_seconds(load_stage), stage_seconds(bake_stage), stage_seconds(write_stage));
+
+    return num_written_assets;
+}
@@ -0,0 +1,422 @@
+#include "bake_server.h"
+
+#include <fmt/core.h>
+
+#ifdef _WIN32
+
+bool run_bake_server(const char * /*socket_path*/, BakeServerSettings const & /*settings*/, BakeSettings const & /*default_settings*/) {
+    fmt::print(stderr, "The bake server needs Unix domain sockets, it is not available on Windows\n");
+    return false;
+}
+
+#else
+
+#include "embree_wrapper.h"
+#include "mesh.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+/// mesh, BVH and brick volumes of a bake per byte of its input file, rough but enough to keep big jobs apart
+constexpr std::size_t JOB_MEMORY_PER_INPUT_BYTE = 8;
+
+/// one request, its connection is answered and closed by the worker running it
+struct BakeJob {
+    int client_socket = -1;
+    std::string mesh_path;
+    std::string inline_mesh;
+    std::string inline_format;
+    std::string output_path;
+    float resolution_scale = 1.0f;
+    bool b_two_sided = false;
+    bool b_detect_two_sided = false; // from the mesh, overrides b_two_sided
+    BakeSettings settings;
+    std::size_t memory_estimate = 0;
+};
+
+bool write_all(int socket, std::string_view data) {
+    while (!data.empty()) {
+        const ssize_t num_written = send(socket, data.data(), data.size(), MSG_NOSIGNAL);
+        if (num_written <= 0) return false;
+        data.remove_prefix(num_written);
+    }
+    return true;
+}
+
+bool read_exact(int socket, char *data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t num_read = recv(socket, data, size, 0);
+        if (num_read <= 0) return false;
+        data += num_read;
+        size -= num_read;
+    }
+    return true;
+}
+
+/// request line without its '\n', nullopt if the connection closes first or the line is longer than `max_length`
+std::optional<std::string> read_line(int socket, std::size_t max_length = 4096) {
+    std::string line;
+    char c;
+    while (read_exact(socket, &c, 1)) {
+        if (c == '\n') return line;
+        if (line.size() == max_length) return std::nullopt;
+        line.push_back(c);
+    }
+    return std::nullopt;
+}
+
+template <typename T>
+bool parse_value(std::string_view text, T &value) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc{} && end == text.data() + text.size();
+}
+
+/// fills `job` from the options of a BAKE line, `error` tells what is wrong otherwise
+bool parse_bake_options(std::string_view options, BakeJob &job, std::size_t &inline_size, std::string &error) {
+    while (!options.empty()) {
+        const std::size_t token_end = std::min(options.find(' '), options.size());
+        const std::string_view token = options.substr(0, token_end);
+        options.remove_prefix(std::min(token_end + 1, options.size()));
+        if (token.empty()) continue;
+
+        const std::size_t separator = token.find('=');
+        const std::string_view key = token.substr(0, separator);
+        const std::string_view value = separator == std::string_view::npos ? std::string_view{} : token.substr(separator + 1);
+
+        bool b_valid = true;
+        if (key == "mesh") {
+            job.mesh_path = value;
+        } else if (key == "inline") {
+            b_valid = parse_value(value, inline_size);
+        } else if (key == "format") {
+            job.inline_format = value;
+        } else if (key == "output") {
+            job.output_path = value;
+        } else if (key == "scale") {
+            b_valid = parse_value(value, job.resolution_scale) && job.resolution_scale > 0.0f;
+        } else if (key == "voxel_density") {
+            b_valid = parse_value(value, job.settings.voxel_density) && job.settings.voxel_density > 0.0f;
+        } else if (key == "two_sided") {
+            job.b_two_sided = value == "1";
+            job.b_detect_two_sided = value == "detect";
+        } else if (key == "morton") {
+            job.settings.morton_brick_order = value == "1";
+        } else if (key == "brick_size") {
+            if (value == "4") {
+                job.settings.brick_config = DistanceField::BRICK_CONFIG_4;
+            } else if (value == "8") {
+                job.settings.brick_config = DistanceField::BRICK_CONFIG_8;
+            } else if (value == "16") {
+                job.settings.brick_config = DistanceField::BRICK_CONFIG_16;
+            } else {
+                b_valid = false;
+            }
+        } else if (key == "refine") {
+            b_valid = parse_value(value, job.settings.refinement_levels);
+        } else if (key == "lod_error") {
+            b_valid = parse_value(value, job.settings.coarse_mip_lod_error) && job.settings.coarse_mip_lod_error >= 0.0f;
+        } else if (key == "sign") {
+            if (value == "rays") {
+                job.settings.sign_mode = SignMode::ray_vote;
+            } else if (value == "pseudo") {
+                job.settings.sign_mode = SignMode::pseudo_normal;
+            } else {
+                b_valid = false;
+            }
+        } else if (key == "encoding") {
+            if (value == "uniform8") {
+                job.settings.encoding = DistanceField::Encoding::uniform_8bit;
+            } else if (value == "brick4") {
+                job.settings.encoding = DistanceField::Encoding::brick_4bit;
+            } else if (value == "brick8") {
+                job.settings.encoding = DistanceField::Encoding::brick_8bit;
+            } else if (value == "brick16") {
+                job.settings.encoding = DistanceField::Encoding::brick_16bit;
+            } else {
+                b_valid = false;
+            }
+        } else {
+            b_valid = false;
+        }
+
+        if (!b_valid) {
+            error = fmt::format("bad option '{}'", token);
+            return false;
+        }
+    }
+
+    if (job.mesh_path.empty() == (inline_size == 0)) {
+        error = "expected either mesh=<path> or inline=<size>";
+        return false;
+    }
+    return true;
+}
+
+/// imports, bakes and serializes the mesh of `job`, the reply to send its client
+std::string bake_reply(BakeJob &job) {
+    std::vector<Mesh> meshes = job.inline_mesh.empty() ? Mesh::importFromFile(job.mesh_path.c_str())
+                                                       : Mesh::importFromMemory(job.inline_mesh, job.inline_format);
+    std::string{}.swap(job.inline_mesh);
+
+    std::string reply;
+    if (meshes.empty()) {
+        reply = "ERROR cannot read mesh\n";
+    } else {
+        Mesh const &mesh = meshes.front();
+        const bool b_two_sided = job.b_detect_two_sided ? mesh.isMostlyTwoSided() : job.b_two_sided;
+
+        DistanceFieldVolumeData volume_data;
+        generate_distance_field_volume_data(mesh, mesh.getAABB(), job.resolution_scale, b_two_sided, job.settings, volume_data);
+
+        if (!job.output_path.empty()) {
+            std::ofstream fout{job.output_path, std::ios_base::binary};
+            DistanceFieldVolumeData::serialize(fout, volume_data);
+            reply = fout ? fmt::format("FILE {}\n", job.output_path) : fmt::format("ERROR cannot write {}\n", job.output_path);
+        } else {
+            std::ostringstream stream;
+            DistanceFieldVolumeData::serialize(stream, volume_data);
+            const std::string data = std::move(stream).str();
+            reply = fmt::format("DATA {}\n", data.size()) + data;
+        }
+    }
+    return reply;
+}
+
+class BakeServer {
+public:
+    BakeServer(BakeServerSettings const &settings, BakeSettings const &default_settings)
+        : settings_{settings}, default_settings_{default_settings} {}
+
+    /// accepts connections until SHUTDOWN, then waits for the requests being read and the queued jobs
+    void run(int listen_socket);
+
+private:
+    void workerMain();
+
+    /// reads the request of a new connection and queues it, or answers it right away when it is not a bake.
+    /// Runs on a thread of its own so a slow client holds up no other, SHUTDOWN stops `run` from accepting
+    void readRequest(int client_socket);
+
+    /// bakes and answers a job
+    static void serve(BakeJob &job);
+
+    const BakeServerSettings settings_;
+    const BakeSettings default_settings_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<BakeJob> queue_;
+    std::size_t running_memory_ = 0;
+    glm::uint32 num_running_jobs_ = 0;
+    glm::uint32 num_reading_requests_ = 0;
+    int listen_socket_ = -1;
+    bool b_shutdown_requested_ = false;
+    bool b_stopping_ = false;
+};
+
+void BakeServer::run(int listen_socket) {
+    listen_socket_ = listen_socket;
+
+    std::vector<std::thread> workers;
+    for (glm::uint32 i = 0; i < std::max(settings_.max_concurrent_jobs, 1u); ++i) workers.emplace_back([this] { workerMain(); });
+
+    while (true) {
+        const int client_socket = accept(listen_socket, nullptr, nullptr);
+        if (client_socket < 0) {
+            if (errno == EINTR) continue;
+
+            std::lock_guard lock{mutex_};
+            if (!b_shutdown_requested_) fmt::print(stderr, "accept failed: {}\n", std::strerror(errno));
+            break;
+        }
+
+        // reads fail once the client stalls for the timeout, the reader thread gives up on it then
+        const timeval timeout{time_t(settings_.request_timeout_seconds), 0};
+        setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        {
+            std::lock_guard lock{mutex_};
+            ++num_reading_requests_;
+        }
+        std::thread{[this, client_socket] {
+            readRequest(client_socket);
+
+            std::lock_guard lock{mutex_};
+            --num_reading_requests_;
+            condition_.notify_all();
+        }}.detach();
+    }
+
+    // requests still being read are queued too, workers stop once the queue is empty after that
+    {
+        std::unique_lock lock{mutex_};
+        condition_.wait(lock, [this] { return num_reading_requests_ == 0; });
+        b_stopping_ = true;
+    }
+    condition_.notify_all();
+    for (auto &worker : workers) worker.join();
+}
+
+void BakeServer::readRequest(int client_socket) {
+    const std::optional<std::string> line = read_line(client_socket);
+
+    if (line && *line == "SHUTDOWN") {
+        write_all(client_socket, "OK\n");
+        close(client_socket);
+
+        std::lock_guard lock{mutex_};
+        b_shutdown_requested_ = true;
+        shutdown(listen_socket_, SHUT_RDWR); // wakes up accept in run
+        return;
+    }
+
+    BakeJob job;
+    job.client_socket = client_socket;
+    job.settings = default_settings_;
+
+    std::string error = "expected BAKE or SHUTDOWN";
+    std::size_t inline_size = 0;
+    bool b_valid = line && line->starts_with("BAKE ") && parse_bake_options(std::string_view{*line}.substr(5), job, inline_size, error);
+    if (b_valid && inline_size > settings_.memory_limit) {
+        error = fmt::format("inline mesh of {} bytes is over the memory limit", inline_size);
+        b_valid = false;
+    }
+
+    if (!b_valid) {
+        write_all(client_socket, fmt::format("ERROR {}\n", error));
+        close(client_socket);
+        return;
+    }
+
+    if (inline_size > 0) {
+        try {
+            job.inline_mesh.resize(inline_size);
+        } catch (std::bad_alloc const &) {
+            write_all(client_socket, "ERROR out of memory for the inline mesh\n");
+            close(client_socket);
+            return;
+        }
+        if (!read_exact(client_socket, job.inline_mesh.data(), inline_size)) {
+            close(client_socket);
+            return;
+        }
+    }
+
+    // the estimate decides admission, a mesh without one would run as if free
+    std::error_code file_error;
+    const std::size_t input_size = inline_size > 0 ? inline_size : (std::size_t) std::filesystem::file_size(job.mesh_path, file_error);
+    if (file_error) {
+        write_all(client_socket, "ERROR cannot read mesh\n");
+        close(client_socket);
+        return;
+    }
+    job.memory_estimate = input_size * JOB_MEMORY_PER_INPUT_BYTE;
+
+    {
+        std::lock_guard lock{mutex_};
+        queue_.push_back(std::move(job));
+    }
+    condition_.notify_all();
+}
+
+void BakeServer::workerMain() {
+    std::unique_lock lock{mutex_};
+    while (true) {
+        // first come first served, the head waits until it fits in the memory limit or runs alone
+        condition_.wait(lock, [this] {
+            return (b_stopping_ && queue_.empty()) ||
+                   (!queue_.empty() &&
+                    (num_running_jobs_ == 0 || running_memory_ + queue_.front().memory_estimate <= settings_.memory_limit));
+        });
+        if (queue_.empty()) return;
+
+        BakeJob job = std::move(queue_.front());
+        queue_.pop_front();
+        running_memory_ += job.memory_estimate;
+        ++num_running_jobs_;
+
+        lock.unlock();
+        serve(job);
+        lock.lock();
+
+        running_memory_ -= job.memory_estimate;
+        --num_running_jobs_;
+        condition_.notify_all();
+    }
+}
+
+void BakeServer::serve(BakeJob &job) {
+    auto job_start_time = std::chrono::steady_clock::now();
+
+    // a request that throws is answered like any other failure, the server keeps serving the others
+    std::string reply;
+    try {
+        reply = bake_reply(job);
+    } catch (std::exception const &exception) {
+        std::string what = exception.what();
+        std::ranges::replace(what, '\n', ' ');
+        reply = fmt::format("ERROR {}\n", what);
+    }
+
+    write_all(job.client_socket, reply);
+    close(job.client_socket);
+
+    auto job_end_time = std::chrono::steady_clock::now();
+    fmt::print("Served {} in {:.3f}s: {}", job.mesh_path.empty() ? "inline mesh" : job.mesh_path,
+               std::chrono::duration<double>(job_end_time - job_start_time).count(), reply.substr(0, reply.find('\n') + 1));
+}
+
+} // namespace
+
+bool run_bake_server(const char *socket_path, BakeServerSettings const &settings, BakeSettings const &default_settings) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (std::strlen(socket_path) >= sizeof(address.sun_path)) {
+        fmt::print(stderr, "Socket path '{}' is too long\n", socket_path);
+        return false;
+    }
+    std::strcpy(address.sun_path, socket_path);
+
+    const int listen_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_socket < 0) return false;
+
+    unlink(socket_path); // left over by a previous server
+    if (bind(listen_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || listen(listen_socket, SOMAXCONN) != 0) {
+        fmt::print(stderr, "Cannot listen on '{}': {}\n", socket_path, std::strerror(errno));
+        close(listen_socket);
+        return false;
+    }
+
+    // pay the device start-up before the first job
+    embree::get_shared_device();
+    fmt::print("Bake server listening on '{}', {} concurrent jobs\n", socket_path, settings.max_concurrent_jobs);
+
+    BakeServer{settings, default_settings}.run(listen_socket);
+
+    close(listen_socket);
+    unlink(socket_path);
+    return true;
+}
+
+#endif
\ No newline at end of file
@@ -1,36 +1,264 @@
 #include "arg_parser.h"
+#include "bake_pipeline.h"
+#include "bake_server.h"
+#include "brick_atlas.h"
 #include "embree_wrapper.h"
 #include "local_sdf.h"
 #include "mesh.h"
+#include "progressive_sdf.h"
 #include "sdf_dump.h"
 #include "sdf_math.h"
+#include "sdf_sampler.h"
+#include "shard_coordinator.h"
 
 #include "format.hpp"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <execution>
 #include <fmt/core.h>
 #include <fstream>
 #include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vector_relational.hpp>
+#include <random>
+#include <thread>
 
 static ArgParser &arg_parser = ArgParser::getInstance();
 
-int main(int argc, const char *argv[]) {
-    arg_parser.parseCommandLine(argc, argv);
+/// random point lookups, then sphere tracing along random rays, on the finest baked mip.
+/// Run with and without -morton to compare brick layouts
+static void benchmark_sampling(DistanceFieldVolumeData const &volume_data, std::size_t num_samples) {
+    glm::uint32 mip_index = 0;
+    while (mip_index < DistanceField::NUM_MIPS && volume_data.mips[mip_index].indirection_dimensions.x == 0) ++mip_index;
+    if (mip_index == DistanceField::NUM_MIPS) return;
+
+    const Box bounds = volume_data.local_space_mesh_bounds;
+    const DistanceFieldMipView mip = *DistanceFieldMipView::create(volume_data, mip_index);
+    const DistanceFieldSampler sampler{mip, bounds};
+
+    std::mt19937 prng{42};
+    std::uniform_real_distribution<float> real_dist(0, 1);
+    const auto random_point = [&] { return bounds.min + glm::vec3{real_dist(prng), real_dist(prng), real_dist(prng)} * bounds.getSize(); };
+
+    std::vector<glm::vec3> points(num_samples);
+    for (auto &point : points) point = random_point();
+
+    auto points_start_time = std::chrono::steady_clock::now();
+    std::vector<float> distances(num_samples);
+    std::transform(std::execution::par_unseq, points.begin(), points.end(), distances.begin(),
+                   [&sampler](glm::vec3 point) { return sampler.sample(point); });
+    auto points_end_time = std::chrono::steady_clock::now();
+    fmt::print("Sampled mip {} at {} random points in {:.1f}ms, {:.1f}ns/sample.\n", mip_index, num_samples,
+               std::chrono::duration<double, std::milli>(points_end_time - points_start_time).count(),
+               std::chrono::duration<double, std::nano>(points_end_time - points_start_time).count() / double(num_samples));
+
+    // each ray touches a run of neighbouring bricks, the case brick order matters for
+    constexpr glm::uint32 max_steps = 64;
+    std::vector<std::pair<glm::vec3, glm::vec3>> rays(std::max<std::size_t>(num_samples / max_steps, 1));
+    for (auto &[origin, direction] : rays) {
+        origin = random_point();
+        direction = glm::normalize(random_point() - origin + glm::vec3(1e-6f));
+    }
+
+    const float min_step = glm::min(mip.voxel_size.x, glm::min(mip.voxel_size.y, mip.voxel_size.z)) * 0.5f;
+    std::atomic<std::size_t> num_ray_samples = 0;
+
+    auto rays_start_time = std::chrono::steady_clock::now();
+    std::for_each(std::execution::par, rays.begin(), rays.end(), [&](std::pair<glm::vec3, glm::vec3> const &ray) {
+        float ray_distance = 0;
+        glm::uint32 step = 0;
+        for (; step < max_steps; ++step) {
+            const glm::vec3 position = ray.first + ray.second * ray_distance;
+            if (glm::any(glm::lessThan(position, bounds.min)) || glm::any(glm::greaterThan(position, bounds.max))) break;
+
+            const float distance = sampler.sample(position);
+            if (distance < 0) break;
+            ray_distance += glm::max(distance, min_step);
+        }
+        num_ray_samples.fetch_add(step, std::memory_order_relaxed);
+    });
+    auto rays_end_time = std::chrono::steady_clock::now();
+    fmt::print("Sphere traced {} random rays ({} samples) in {:.1f}ms, {:.1f}ns/sample.\n", rays.size(), num_ray_samples.load(),
+               std::chrono::duration<double, std::milli>(rays_end_time - rays_start_time).count(),
+               std::chrono::duration<double, std::nano>(rays_end_time - rays_start_time).count() /
+                   double(std::max<std::size_t>(num_ray_samples, 1)));
+}
+
+/// batched exact queries on the source mesh at random points around it, unsigned then signed
+static void benchmark_mesh_queries(Mesh const &mesh, std::size_t num_queries) {
+    embree::Scene embree_scene;
+    embree_scene.addMesh(mesh);
+    embree_scene.commit();
+
+    const Box bounds = mesh.getAABB().expandBy(mesh.getAABB().getExtent() * 0.25f);
+
+    std::mt19937 prng{42};
+    std::uniform_real_distribution<float> real_dist(0, 1);
+    std::vector<glm::vec3> points(num_queries);
+    for (auto &point : points) point = bounds.min + glm::vec3{real_dist(prng), real_dist(prng), real_dist(prng)} * bounds.getSize();
 
+    std::vector<embree::MeshQueryResult> results(num_queries);
+    for (const bool b_signed : {false, true}) {
+        const embree::MeshQuerySettings settings{.b_signed = b_signed, .num_sign_rays = arg_parser.bake_settings.num_sign_rays[0]};
+
+        auto query_start_time = std::chrono::steady_clock::now();
+        embree_scene.queryClosest(points, settings, results);
+        auto query_end_time = std::chrono::steady_clock::now();
+
+        const std::size_t num_inside =
+            std::ranges::count_if(results, [](embree::MeshQueryResult const &result) { return result.distance < 0; });
+        fmt::print("{} {} closest point queries in {:.1f}ms, {:.0f} queries/s, {} inside.\n", num_queries, b_signed ? "signed" : "unsigned",
+                   std::chrono::duration<double, std::milli>(query_end_time - query_start_time).count(),
+                   double(num_queries) / std::chrono::duration<double>(query_end_time - query_start_time).count(), num_inside);
+    }
+}
+
+/// registers a written volume in a brick atlas and streams it in down to mip 0, as a renderer would
+static void stream_through_atlas(std::string const &file_path, std::size_t memory_budget) {
+    BrickAtlas atlas{BrickAtlasSettings{.memory_budget = memory_budget,
+                                        .encoding = arg_parser.bake_settings.encoding,
+                                        .brick_config = arg_parser.bake_settings.brick_config}};
+    const auto asset_id = atlas.registerAsset(file_path.c_str());
+    if (!asset_id) {
+        fmt::print(stderr, "Failed to register {} in the brick atlas\n", file_path);
+        return;
+    }
+
+    // a pool too small for mip 0 stops it, failed reads are retried for a while
+    auto stream_start_time = std::chrono::steady_clock::now();
+    while (atlas.getFinestResidentMip(*asset_id) != 0 && !atlas.isMipOutOfSlots(*asset_id, 0) &&
+           std::chrono::steady_clock::now() - stream_start_time < std::chrono::seconds(5)) {
+        atlas.requestMip(*asset_id, 0);
+        atlas.update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto stream_end_time = std::chrono::steady_clock::now();
+
+    fmt::print("Streamed in down to mip {} in {:.1f}ms, {}/{} atlas slots used.\n", atlas.getFinestResidentMip(*asset_id),
+               std::chrono::duration<double, std::milli>(stream_end_time - stream_start_time).count(),
+               atlas.getNumSlots() - atlas.getNumFreeSlots(), atlas.getNumSlots());
+    if (atlas.isMipOutOfSlots(*asset_id, 0)) fmt::print("Mip 0 does not fit in the atlas.\n");
+}
+
+/// replaces every mesh by its preprocessed version
+/// \return seconds spent
+static double preprocess_meshes(std::vector<Mesh> &meshes) {
+    double preprocess_seconds = 0.0;
+    for (Mesh &input_mesh : meshes) {
+        auto preprocess_start_time = std::chrono::steady_clock::now();
+        Mesh preprocessed_mesh = input_mesh.preprocess(arg_parser.weld_distance);
+        auto preprocess_end_time = std::chrono::steady_clock::now();
+
+        const double mesh_seconds = std::chrono::duration<double>(preprocess_end_time - preprocess_start_time).count();
+        fmt::print("Preprocessed mesh in {:.3f}s: {} -> {} vertices, {} -> {} triangles.\n", mesh_seconds, input_mesh.vertices.size(),
+                   preprocessed_mesh.vertices.size(), input_mesh.indices.size(), preprocessed_mesh.indices.size());
+        input_mesh = std::move(preprocessed_mesh);
+        preprocess_seconds += mesh_seconds;
+    }
+    return preprocess_seconds;
+}
+
+/// reads and optionally preprocesses the meshes of a model, empty if it cannot be read
+static std::vector<Mesh> load_input_meshes(const char *file_path) {
     auto read_start_time = std::chrono::system_clock::now();
-    const std::vector<Mesh> meshes = Mesh::importFromFile(arg_parser.input_filename);
-    const Mesh &mesh = meshes.front();
+    std::vector<Mesh> meshes = Mesh::importFromFile(file_path, !arg_parser.use_assimp);
+    if (meshes.empty()) {
+        fmt::print(stderr, "Cannot read model '{}'\n", file_path);
+        return meshes;
+    }
     auto read_end_time = std::chrono::system_clock::now();
-    fmt::print("Read PLY model '{}' in {:.1f}s.\n", arg_parser.input_filename,
-               std::chrono::duration<double>(read_end_time - read_start_time).count());
+    fmt::print("Read model '{}' in {:.3f}s.\n", file_path, std::chrono::duration<double>(read_end_time - read_start_time).count());
 
-    DistanceFieldVolumeData volume_data;
-    generate_distance_field_volume_data(mesh, mesh.getAABB(), arg_parser.df_resolution_scale, volume_data);
+    if (!arg_parser.all_meshes) meshes.resize(1);
+
+    // -bench-preprocess needs the meshes as read first
+    if (arg_parser.preprocess && !arg_parser.bench_preprocess) preprocess_meshes(meshes);
+    return meshes;
+}
+
+/// bakes loaded meshes in this process, false if nothing was baked
+static bool bake_meshes(std::vector<Mesh> const &meshes, DistanceFieldVolumeData &volume_data) {
+    const bool b_two_sided =
+        arg_parser.two_sided || (arg_parser.detect_two_sided && std::ranges::any_of(meshes, &Mesh::isMostlyTwoSided));
+    if (b_two_sided) fmt::print("Baking as two-sided, distance is unsigned.\n");
+
+    // every mesh in place, then once more per repeat offset, copies only add an instance of the same BVH
+    std::vector<MeshInstance> instances;
+    for (Mesh const &input_mesh : meshes) instances.push_back({&input_mesh});
+    for (glm::vec3 offset : arg_parser.repeat_offsets) {
+        for (Mesh const &input_mesh : meshes) {
+            MeshInstance &instance = instances.emplace_back(&input_mesh);
+            instance.transform[3] = offset;
+        }
+    }
+
+    Box bounds = instances.front().getAABB();
+    for (MeshInstance const &instance : instances) {
+        const Box instance_bounds = instance.getAABB();
+        bounds = {glm::min(bounds.min, instance_bounds.min), glm::max(bounds.max, instance_bounds.max)};
+    }
+    if (instances.size() > 1) fmt::print("Baking {} instances of {} meshes into one volume.\n", instances.size(), meshes.size());
 
-    /// visualization for mips
+    // a shard worker always bakes its slab completely
+    if (arg_parser.time_budget > 0 && arg_parser.bake_settings.num_shards == 1) {
+        ProgressiveDistanceFieldBake progressive_bake{
+            instances, bounds, arg_parser.df_resolution_scale, b_two_sided, arg_parser.bake_settings,
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(arg_parser.time_budget)),
+            [](DistanceFieldVolumeData const & /*unused*/, glm::uint32 mip_index) { fmt::print("Mip level {} ready\n", mip_index); }};
 
+        while (!progressive_bake.isFinished()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            fmt::print("Baking... {:.1f}%\n", progressive_bake.getProgress() * 100.0f);
+        }
+
+        const glm::uint32 finest_mip_index = progressive_bake.wait(volume_data);
+        if (finest_mip_index == DistanceField::NUM_MIPS) {
+            fmt::print(stderr, "Time budget exhausted before any mip was complete\n");
+            return false;
+        }
+        fmt::print("Progressive bake stopped at mip level {}\n", finest_mip_index);
+    } else {
+        generate_distance_field_volume_data(instances, bounds, arg_parser.df_resolution_scale, b_two_sided, arg_parser.bake_settings,
+                                            volume_data);
+    }
+
+    return true;
+}
+
+/// bakes the meshes as read, then preprocessed, keeping the latter bake and reporting the time preprocessing saves in the bake
+static bool bench_preprocess(std::vector<Mesh> meshes, DistanceFieldVolumeData &volume_data) {
+    auto raw_bake_start_time = std::chrono::steady_clock::now();
+    DistanceFieldVolumeData raw_volume_data;
+    if (!bake_meshes(meshes, raw_volume_data)) return false;
+    auto raw_bake_end_time = std::chrono::steady_clock::now();
+
+    const double preprocess_seconds = preprocess_meshes(meshes);
+
+    auto bake_start_time = std::chrono::steady_clock::now();
+    if (!bake_meshes(meshes, volume_data)) return false;
+    auto bake_end_time = std::chrono::steady_clock::now();
+
+    const double raw_bake_seconds = std::chrono::duration<double>(raw_bake_end_time - raw_bake_start_time).count();
+    const double bake_seconds = std::chrono::duration<double>(bake_end_time - bake_start_time).count();
+    fmt::print("Preprocessing saved {:.3f}s of the bake ({:.3f}s -> {:.3f}s) for {:.3f}s of preprocessing, {:.3f}s net.\n",
+               raw_bake_seconds - bake_seconds, raw_bake_seconds, bake_seconds, preprocess_seconds,
+               raw_bake_seconds - bake_seconds - preprocess_seconds);
+    return true;
+}
+
+/// bakes loaded meshes as the arguments ask, the query benchmark runs once before and outside any timed bake
+static bool bake_loaded_meshes(std::vector<Mesh> const &meshes, DistanceFieldVolumeData &volume_data) {
+    if (arg_parser.bench_queries > 0) benchmark_mesh_queries(meshes.front(), arg_parser.bench_queries);
+    return arg_parser.bench_preprocess ? bench_preprocess(meshes, volume_data) : bake_meshes(meshes, volume_data);
+}
+
+/// visualization dump and serialized volume, `<output_prefix>.bin` for the latter
+static bool write_results(DistanceFieldVolumeData const &volume_data, std::string const &output_prefix) {
     auto write_start_time = std::chrono::system_clock::now();
 
-    dump_sdf_volume_for_visualization(volume_data);
+    bool b_dumped = dump_sdf_volume_for_visualization(volume_data, output_prefix.c_str(), arg_parser.debug_brick);
+    if (arg_parser.dump_surface) b_dumped &= dump_sdf_iso_surface(volume_data, output_prefix.c_str());
 
     auto write_end_time = std::chrono::system_clock::now();
     fmt::print("Write results in {:.1f}s.\n", std::chrono::duration<double>(write_end_time - write_start_time).count());
@@ -38,12 +266,108 @@ int main(int argc, const char *argv[]) {
     auto serialize_start_time = std::chrono::steady_clock::now();
 
     // serialize to binary file
-    std::ofstream fout{fmt::format("{}.bin", arg_parser.output_filename), std::ios_base::binary};
+    std::ofstream fout{fmt::format("{}.bin", output_prefix), std::ios_base::binary};
     DistanceFieldVolumeData::serialize(fout, volume_data);
 
     auto serialize_end_time = std::chrono::steady_clock::now();
     fmt::print("Write binary results in {:.1f}ms.\n",
                std::chrono::duration<double>(serialize_end_time - serialize_start_time).count() * 1000);
+    return b_dumped && bool(fout);
+}
+
+/// replaces the bake by its combination with the volume serialized in `operand_path`, placed by the CSG settings
+static bool combine_with_volume(DistanceFieldVolumeData &volume_data, const char *operand_path) {
+    std::ifstream fin{operand_path, std::ios_base::binary};
+    if (!fin) {
+        fmt::print(stderr, "Cannot open '{}'\n", operand_path);
+        return false;
+    }
+    DistanceFieldVolumeData operand_data;
+    if (!DistanceFieldVolumeData::deserialize(fin, operand_data)) {
+        fmt::print(stderr, "Cannot read '{}', not a distance field volume of this version\n", operand_path);
+        return false;
+    }
+
+    CsgSettings csg_settings = arg_parser.csg_settings;
+    csg_settings.parallel = arg_parser.bake_settings.parallel;
+    csg_settings.morton_brick_order = arg_parser.bake_settings.morton_brick_order;
+
+    DistanceFieldVolumeData combined_data;
+    if (!combine_distance_fields(volume_data, operand_data, csg_settings, combined_data)) {
+        fmt::print(stderr, "Cannot combine with '{}', a mip of either volume is missing\n", operand_path);
+        return false;
+    }
+    volume_data = std::move(combined_data);
+    return true;
+}
+
+/// one model per line of the batch list, baked through the pipeline into `<output>_<line index>`
+static bool bake_batch(const char *batch_list_path) {
+    std::vector<std::string> input_paths;
+    std::ifstream fin{batch_list_path};
+    for (std::string line; std::getline(fin, line);) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty() && line.front() != '#') input_paths.push_back(line);
+    }
+    if (input_paths.empty()) {
+        fmt::print(stderr, "No model listed in '{}'\n", batch_list_path);
+        return false;
+    }
+
+    BakePipelineStages stages;
+    stages.load = [&input_paths](std::size_t asset_index, std::vector<Mesh> &out_meshes) {
+        out_meshes = load_input_meshes(input_paths[asset_index].c_str());
+        return !out_meshes.empty();
+    };
+    stages.bake = [](std::size_t /*unused*/, std::vector<Mesh> const &meshes, DistanceFieldVolumeData &out_data) {
+        return bake_loaded_meshes(meshes, out_data);
+    };
+    stages.write = [&input_paths](std::size_t asset_index, DistanceFieldVolumeData const &data) {
+        const std::string output_prefix = fmt::format("{}_{}", arg_parser.output_filename, asset_index);
+        const bool b_written = write_results(data, output_prefix);
+        fmt::print("{} '{}' to '{}.bin'\n", b_written ? "Wrote" : "Failed to write", input_paths[asset_index], output_prefix);
+        return b_written;
+    };
+    return run_bake_pipeline(input_paths.size(), arg_parser.pipeline_settings, stages) == input_paths.size();
+}
+
+int main(int argc, const char *argv[]) {
+    arg_parser.parseCommandLine(argc, argv);
+
+    if (arg_parser.serve_socket) {
+        return run_bake_server(arg_parser.serve_socket, arg_parser.server_settings, arg_parser.bake_settings) ? 0 : 1;
+    }
+
+    if (arg_parser.batch_list) return bake_batch(arg_parser.batch_list) ? 0 : 1;
+
+    DistanceFieldVolumeData volume_data;
+    if (arg_parser.shard_settings.num_shards > 1 && arg_parser.bake_settings.num_shards == 1) {
+        // coordinator, workers rerun this command line on their shard
+        if (!run_sharded_bake(std::vector<std::string>(argv, argv + argc), arg_parser.output_filename, arg_parser.shard_settings,
+                              arg_parser.bake_settings, volume_data)) {
+            return 1;
+        }
+    } else {
+        const std::vector<Mesh> meshes = load_input_meshes(arg_parser.input_filename);
+        if (meshes.empty()) return 1;
+        if (!bake_loaded_meshes(meshes, volume_data)) return 1;
+    }
+
+    if (arg_parser.bake_settings.num_shards > 1) {
+        // shard worker, the coordinator merges and writes everything else
+        std::ofstream fout{fmt::format("{}.bin", arg_parser.output_filename), std::ios_base::binary};
+        DistanceFieldVolumeData::serialize(fout, volume_data);
+        return fout ? 0 : 1;
+    }
+
+    if (arg_parser.csg_operand && !combine_with_volume(volume_data, arg_parser.csg_operand)) return 1;
+
+    /// visualization for mips and binary file
+    if (!write_results(volume_data, arg_parser.output_filename)) return 1;
+
+    if (arg_parser.bench_samples > 0) benchmark_sampling(volume_data, arg_parser.bench_samples);
+
+    if (arg_parser.atlas_budget > 0) stream_through_atlas(fmt::format("{}.bin", arg_parser.output_filename), arg_parser.atlas_budget);
 
     // std::ifstream fin{fmt::format("{}.bin", arg_parser.output_filename), std::ios_base::binary};
     // DistanceFieldVolumeData tmp;
@@ -0,0 +1,196 @@
+#include "shard_coordinator.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fmt/core.h>
+#include <fstream>
+#include <optional>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/// child process baking one shard
+class WorkerProcess {
+public:
+    bool start(std::vector<std::string> const &args);
+
+    /// exit code once the process is gone, nullopt while it runs
+    std::optional<int> poll();
+
+    void kill();
+
+private:
+#ifdef _WIN32
+    HANDLE process_handle_ = nullptr;
+#else
+    pid_t pid_ = -1;
+#endif
+};
+
+bool WorkerProcess::start(std::vector<std::string> const &args) {
+#ifdef _WIN32
+    std::string command_line;
+    for (std::string const &arg : args) command_line += fmt::format("\"{}\" ", arg);
+
+    STARTUPINFOA startup_info{};
+    startup_info.cb = sizeof(startup_info);
+    PROCESS_INFORMATION process_info{};
+    if (!CreateProcessA(nullptr, command_line.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup_info, &process_info)) {
+        return false;
+    }
+
+    CloseHandle(process_info.hThread);
+    process_handle_ = process_info.hProcess;
+    return true;
+#else
+    std::vector<char *> argv;
+    for (std::string const &arg : args) argv.push_back(const_cast<char *>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    pid_ = fork();
+    if (pid_ == 0) {
+        execvp(argv[0], argv.data());
+        _exit(127); // exec failed, shows up as a failed shard
+    }
+    return pid_ > 0;
+#endif
+}
+
+std::optional<int> WorkerProcess::poll() {
+#ifdef _WIN32
+    if (WaitForSingleObject(process_handle_, 0) == WAIT_TIMEOUT) return std::nullopt;
+
+    DWORD exit_code = 1;
+    GetExitCodeProcess(process_handle_, &exit_code);
+    CloseHandle(process_handle_);
+    process_handle_ = nullptr;
+    return (int) exit_code;
+#else
+    int status = 0;
+    if (waitpid(pid_, &status, WNOHANG) == 0) return std::nullopt;
+
+    pid_ = -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1; // killed by a signal
+#endif
+}
+
+void WorkerProcess::kill() {
+#ifdef _WIN32
+    if (process_handle_ == nullptr) return;
+    TerminateProcess(process_handle_, 1);
+    WaitForSingleObject(process_handle_, INFINITE);
+    CloseHandle(process_handle_);
+    process_handle_ = nullptr;
+#else
+    if (pid_ <= 0) return;
+    ::kill(pid_, SIGKILL);
+    waitpid(pid_, nullptr, 0);
+    pid_ = -1;
+#endif
+}
+
+} // namespace
+
+bool run_sharded_bake(std::vector<std::string> const &worker_command, std::string const &shard_prefix, ShardedBakeSettings const &settings,
+                      BakeSettings const &bake_settings, DistanceFieldVolumeData &out_data) {
+    struct Shard {
+        WorkerProcess process;
+        std::string output_prefix;
+        glm::uint32 num_attempts = 0;
+        std::chrono::steady_clock::time_point start_time;
+        bool b_running = false; // false after a failed start, retried like a crash
+        bool b_done = false;
+    };
+
+    std::vector<Shard> shards(settings.num_shards);
+
+    auto start_shard = [&](glm::uint32 shard_index) {
+        Shard &shard = shards[shard_index];
+        std::vector<std::string> args = worker_command;
+        args.insert(args.end(), {"-shard", std::to_string(shard_index), std::to_string(settings.num_shards), "-o", shard.output_prefix});
+
+        ++shard.num_attempts;
+        shard.start_time = std::chrono::steady_clock::now();
+        shard.b_running = shard.process.start(args);
+    };
+
+    auto stop_all = [&shards] {
+        for (Shard &shard : shards) shard.process.kill();
+    };
+
+    auto bake_start_time = std::chrono::steady_clock::now();
+
+    for (glm::uint32 shard_index = 0; shard_index < settings.num_shards; ++shard_index) {
+        shards[shard_index].output_prefix = fmt::format("{}.shard{}", shard_prefix, shard_index);
+        start_shard(shard_index);
+    }
+
+    for (glm::uint32 num_done_shards = 0; num_done_shards < settings.num_shards;) {
+        for (glm::uint32 shard_index = 0; shard_index < settings.num_shards; ++shard_index) {
+            Shard &shard = shards[shard_index];
+            if (shard.b_done) continue;
+
+            const double elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - shard.start_time).count();
+            const std::optional<int> exit_code = shard.b_running ? shard.process.poll() : std::optional<int>{-1};
+
+            if (!exit_code) {
+                if (settings.timeout <= 0.0f || elapsed_seconds < settings.timeout) continue;
+
+                shard.process.kill();
+                fmt::print(stderr, "Shard {} timed out after {:.1f}s\n", shard_index, elapsed_seconds);
+            } else if (*exit_code == 0) {
+                shard.b_done = true;
+                ++num_done_shards;
+                fmt::print("Shard {} finished in {:.1f}s\n", shard_index, elapsed_seconds);
+                continue;
+            } else {
+                fmt::print(stderr, "Shard {} failed with exit code {}\n", shard_index, *exit_code);
+            }
+
+            if (shard.num_attempts >= settings.max_attempts) {
+                stop_all();
+                fmt::print(stderr, "Shard {} failed {} times, giving up\n", shard_index, shard.num_attempts);
+                return false;
+            }
+            start_shard(shard_index);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    auto merge_start_time = std::chrono::steady_clock::now();
+
+    std::vector<DistanceFieldVolumeData> shard_data(settings.num_shards);
+    for (glm::uint32 shard_index = 0; shard_index < settings.num_shards; ++shard_index) {
+        const std::string shard_file_path = fmt::format("{}.bin", shards[shard_index].output_prefix);
+        {
+            std::ifstream fin{shard_file_path, std::ios_base::binary};
+            if (!DistanceFieldVolumeData::deserialize(fin, shard_data[shard_index])) {
+                fmt::print(stderr, "Failed to read shard {} from {}\n", shard_index, shard_file_path);
+                return false;
+            }
+        }
+        std::filesystem::remove(shard_file_path);
+    }
+
+    if (!merge_distance_field_shards(shard_data, bake_settings, out_data)) {
+        fmt::print(stderr, "Shards do not belong to the same bake\n");
+        return false;
+    }
+
+    auto merge_end_time = std::chrono::steady_clock::now();
+    fmt::print("Sharded bake in {} workers finished in {:.1f}s, merged in {:.1f}ms.\n", settings.num_shards,
+               std::chrono::duration<double>(merge_start_time - bake_start_time).count(),
+               std::chrono::duration<double, std::milli>(merge_end_time - merge_start_time).count());
+    return true;
+}
\ No newline at end of file
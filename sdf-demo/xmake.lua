@@ -4,5 +4,6 @@ target("sdf-demo")
     set_kind("binary")
     add_files("src/*.cpp")
     add_includedirs("include")
+    add_deps("sdf-core")
     add_packages("fmt", "embree", "glm", "assimp")
-    
\ No newline at end of file
+    
\ No newline at end of file